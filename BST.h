@@ -6,30 +6,146 @@
  * 
  * Basic operations include:
  * - Constructor: Constructs an empty BST
+ * - Copy constructor, assignment operator: Deep copy of a BST
+ * - Move constructor, move assignment: Transfer a BST in O(1)
+ * - Destructor: Releases all nodes of a BST
  * - empty: Checks if a BST is empty
  * - search: Search a BST for an item
+ * - search_batch, find_batch: Search a BST for many items at once
  * - insert: Inserts a value into a BST
  * - remove: Removes a value from a BST
- * - inorder: Inorder traversal of a BST -- output the data values
+ * - try_insert, try_erase: Non-throwing insert and remove reporting the outcome
+ * - emplace: Constructs a value in place inside its node and inserts it
+ * - insert_sorted_batch: Inserts a sorted batch, resuming each descent
+ *   near the previous insertion point
+ * - build_sorted, build: Replace the contents with a perfectly balanced
+ *   tree built from a range in linear time (after sorting, for build)
+ * - build_parallel, clear_parallel: build_sorted and clear forked over
+ *   subtrees onto a work-stealing ThreadPool
+ * - split, join: Partition a tree at a key, or concatenate two trees, by
+ *   relinking nodes in O(log n) (split needs OrderStatistics for that)
+ * - set_union, set_intersection, set_difference: Join-based bulk set
+ *   operations
+ * - inorder, preorder, postorder: Depth-first traversals of a BST -- output
+ *   the data values
+ * - levelorder: Level-by-level traversal of a BST
+ * - for_each_inorder, for_each_preorder, for_each_postorder,
+ *   for_each_levelorder: Traversals calling a visitor, with early exit
  * - graph: Output a graphical representation of a BST
+ * - write_inorder, write_graph: Buffered versions of inorder and graph for
+ *   bulk dumps (see BufferedWriter.h)
+ * - begin, end: Bidirectional iterators visiting the data values in order
+ * - size: Number of items in O(1)
+ * - lower_bound, upper_bound, equal_range: Ordered position queries
+ * - rank, select, count_range: Order statistics in O(log n) for balanced
+ *   trees with OrderStatistics enabled
+ * - aggregate: Combine the items in a half-open interval in O(log n) for
+ *   balanced trees with an augmentation policy
+ * - range: Visit the data values in a half-open interval
+ * - freeze: Export the data values into a read-only FrozenBST snapshot
  * 
  * Private utility helper operations include:
  * - search2: Used by delete
- * - inorderAux: Used by inorder
+ * - inorderAux, preorderAux, postorderAux: Used by the traversals
+ * - visitItem: Calls a visitor and reports whether to continue
  * - graphAux: Used by graph
  * 
  * Other operations described in the exercises include:
- * - destructor
- * - copy constructor
- * - assignment operator
- * - preorder, postorder, and level-by-level traversals
  * - level finder
+ *
+ * Nodes are obtained from the allocator given as the second template
+ * parameter (rebound to the node type).  The default PoolAllocator serves
+ * them from large chunks and recycles freed nodes through a free list.
+ * Every tree owns a pool, created on its first insertion, and nodes
+ * released by remove are kept for reuse rather than returned to the
+ * system.  clear, clear_parallel and the destructor return the whole pool
+ * at once unless another tree (e.g. the other half of a split) still
+ * shares it.  Pass std::allocator<DataType> to allocate and free each node
+ * individually instead.
+ *
+ * The third template parameter selects a balancing policy (see BSTBalance.h).
+ * With RedBlack or AVL, insert and remove rebalance the tree so that search
+ * is O(log n) regardless of the insertion order.
+ *
+ * Items are ordered by the Compare template parameter (std::less<> by
+ * default).  When Compare is transparent, search, find, lower_bound and
+ * upper_bound also accept any key type comparable with DataType, so no
+ * temporary DataType has to be built for a lookup.
+ *
+ * Setting the OrderStatistics template parameter stores the size of its
+ * subtree in every node, kept up to date by insert, remove and the
+ * rotations of the balancing policy.  rank, select and count_range need
+ * it; trees without it carry no extra per-node data.
+ *
+ * Likewise, the Augment template parameter selects a monoid whose subtree
+ * aggregates are kept in the nodes (see BSTAugment.h), for aggregate range
+ * queries.  The default NoAugment adds nothing.
+ *
+ * The descents in insert, search, search2 and remove make one three-way
+ * comparison per node: Compare::compare if the comparator provides it,
+ * operator<=> if Compare is std::less and the types support it, and two
+ * calls to Compare otherwise.
  */
 
+#ifndef BST_H_
+#define BST_H_
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BSTAugment.h"
+#include "BSTBalance.h"
+#include "BufferedWriter.h"
+#include "FrozenBST.h"
+#include "PoolAllocator.h"
+#include "ThreadPool.h"
+
+/**
+ * @brief Satisfied by comparators that compare DataType with other key types.
+ */
+template <typename Compare>
+concept TransparentCompare = requires { typename Compare::is_transparent; };
+
+/**
+ * @brief Satisfied by comparators that also provide a three-way compare(a, b)
+ *        returning an ordering (< 0, == 0, > 0) consistent with operator().
+ */
+template <typename Compare, typename Key, typename DataType>
+concept ThreeWayCompare = requires(const Compare& compare, const Key& key, const DataType& data)
+{
+    compare.compare(key, data) < 0;
+};
+
+/**
+ * @class SubtreeSize
+ * @brief Node count of a subtree, stored in the nodes of BSTs with order
+ *        statistics; empty (and free, as a base class) otherwise.
+ */
+template <bool Enabled>
+class SubtreeSize
+{};
+
+template <>
+class SubtreeSize<true>
+{
+public:
+    std::size_t size = 1;    // number of nodes in the subtree rooted here
+};
 
 /**
  * @class BST
@@ -37,49 +153,368 @@
  *
  * This class represents a binary search tree data structure. It supports
  * operations such as insertion, deletion, and searching of elements in the tree.
+ *
+ * @tparam DataType Type of the stored items.
+ * @tparam Alloc Allocator used for the tree nodes (rebound to the node type).
+ * @tparam Balance Balancing policy: Unbalanced, RedBlack or AVL.
+ * @tparam Compare Strict weak ordering of the items.
+ * @tparam OrderStatistics true to store subtree sizes in the nodes, enabling
+ *         rank, select and count_range in O(log n) on a balanced tree.
+ * @tparam Augment Augmentation policy whose subtree aggregates are stored
+ *         in the nodes, enabling aggregate (see BSTAugment.h).
  */
-template <typename DataType>
+template <typename DataType,
+          typename Alloc = PoolAllocator<DataType>,
+          typename Balance = Unbalanced,
+          typename Compare = std::less<>,
+          bool OrderStatistics = false,
+          typename Augment = NoAugment>
 class BST
 {
 private:
     /***** Node structure *****/
-    class BinNode
+    class BinNode : public Balance::NodeData, public SubtreeSize<OrderStatistics>,
+                    public SubtreeAggregate<Augment>
     {
     public:
+        // BSTNodeOps calls update() bottom-up when a subtree changes
+        static constexpr bool augmented = OrderStatistics || !std::is_same_v<Augment, NoAugment>;
+
         DataType data;
         BinNode* left;
         BinNode* right;
+        BinNode* parent;
 
         // BinNode constructors
-        // Default -- data part undefined; both links null
+        // Default -- data part undefined; all links null
         BinNode()
-            : left(nullptr), right(nullptr)
+            : left(nullptr), right(nullptr), parent(nullptr)
+        {}
+
+        // Copy -- data part, balancing data and subtree data copied; all links null
+        BinNode(const BinNode& other)
+            : Balance::NodeData(other), SubtreeSize<OrderStatistics>(other),
+              SubtreeAggregate<Augment>(other), data(other.data),
+              left(nullptr), right(nullptr), parent(nullptr)
         {}
 
-        // Explicit Value -- data part contains item; both links null
-        BinNode(DataType item)
-            : data(item), left(nullptr), right(nullptr)
+        // Explicit Value -- data part constructed in place from args; all links null
+        template <typename... Args>
+        explicit BinNode(std::in_place_t, Args&&... args)
+            : data(std::forward<Args>(args)...),
+              left(nullptr), right(nullptr), parent(nullptr)
         {}
+
+        // Recomputes the subtree size and aggregate from the children
+        void update()
+        {
+            if constexpr (OrderStatistics)
+            {
+                this->size = 1 + (left != nullptr ? left->size : 0)
+                               + (right != nullptr ? right->size : 0);
+            }
+            if constexpr (!std::is_same_v<Augment, NoAugment>)
+            {
+                this->aggregate = Augment::lift(data);
+                if (left != nullptr)
+                    this->aggregate = Augment::combine(left->aggregate, this->aggregate);
+                if (right != nullptr)
+                    this->aggregate = Augment::combine(this->aggregate, right->aggregate);
+            }
+        }
     };
 
     typedef BinNode* BinNodePointer;
 
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<BinNode> NodeAllocator;
+    typedef std::allocator_traits<NodeAllocator> NodeAllocTraits;
+
 public:
+    typedef Alloc allocator_type;
+    typedef Compare key_compare;
+
+    /***** Iterator *****/
+    /**
+     * @class const_iterator
+     * @brief Bidirectional iterator visiting the items in order.
+     *
+     * Steps follow the parent links, so a full traversal crosses every edge
+     * twice (O(1) amortized per step).  Items are read-only, since changing
+     * one in place could break the ordering.  Removing an item invalidates
+     * only the iterators referring to it.
+     */
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef DataType value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const DataType* pointer;
+        typedef const DataType& reference;
+
+        const_iterator()
+            : myNode(nullptr), myTree(nullptr)
+        {}
+
+        reference operator*() const
+        {
+            return myNode->data;
+        }
+
+        pointer operator->() const
+        {
+            return &myNode->data;
+        }
+
+        const_iterator& operator++()
+        {
+            myNode = BSTNodeOps::successor(myNode);
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        // Decrementing end() yields the last item
+        const_iterator& operator--()
+        {
+            if (myNode == nullptr)
+                myNode = BSTNodeOps::maximum(myTree->myRoot);
+            else
+                myNode = BSTNodeOps::predecessor(myNode);
+            return *this;
+        }
+
+        const_iterator operator--(int)
+        {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        friend bool operator==(const const_iterator& a, const const_iterator& b)
+        {
+            return a.myNode == b.myNode;
+        }
+
+    private:
+        friend class BST;
+
+        const_iterator(BinNodePointer node, const BST* tree)
+            : myNode(node), myTree(tree)
+        {}
+
+        BinNodePointer myNode;   // null for end()
+        const BST* myTree;
+    };
+
+    typedef const_iterator iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef const_reverse_iterator reverse_iterator;
+
     /**
      * @brief Default constructor for the BST class.
+     *
+     * @param alloc Allocator used to obtain the tree nodes (optional).
+     */
+    explicit BST(const Alloc& alloc = Alloc());
+
+    /**
+     * @brief Constructs an empty BST ordered by the given comparator.
+     *
+     * @param compare Comparator used to order the items.
+     * @param alloc Allocator used to obtain the tree nodes (optional).
+     */
+    explicit BST(const Compare& compare, const Alloc& alloc = Alloc());
+
+    /**
+     * @brief Copy constructor -- builds a deep copy of other.
+     *
+     * The shape of other is cloned in a single linear, non-recursive pass;
+     * no comparisons are made.  The copy gets its allocator from
+     * select_on_container_copy_construction.
+     *
+     * @param other The tree to copy.
+     */
+    BST(const BST& other);
+
+    /**
+     * @brief Move constructor -- takes over the nodes of other in O(1).
+     *
+     * The allocator is moved along with the nodes.  A moved-from
+     * PoolAllocator has no pool, so other can be reused, even on another
+     * thread, without touching this tree's pool.
+     *
+     * @param other The tree to move from; left empty.
      */
-    BST();
+    BST(BST&& other) noexcept;
+
+    /**
+     * @brief Assignment operator -- replaces the contents with a deep copy of other.
+     *
+     * @param other The tree to copy.
+     * @return Reference to this tree.
+     */
+    BST& operator=(const BST& other);
+
+    /**
+     * @brief Move assignment -- takes over the nodes of other.
+     *
+     * O(1) when the allocators propagate or compare equal; otherwise the
+     * items are copied into nodes from this tree's allocator.  As with the
+     * move constructor, a PoolAllocator moves along with the nodes and
+     * other is left independent of this tree.
+     *
+     * @param other The tree to move from; left empty.
+     * @return Reference to this tree.
+     */
+    BST& operator=(BST&& other);
 
     /**
      * @brief Default destructor for the BST class.
      */
     ~BST();
 
+    /**
+     * @brief Exchanges the contents of this tree and other in O(1).
+     *
+     * @param other The tree to swap with.
+     */
+    void swap(BST& other) noexcept;
+
     /**
      * @brief Clears the binary search tree.
+     *
+     * If no other tree shares its PoolAllocator's pool, the pool hands all
+     * of its memory back at once instead of keeping the nodes for reuse.
      */
     void clear();
 
+    /**
+     * @brief Replaces the contents with the items of a sorted range.
+     *
+     * Builds a perfectly balanced tree in O(n) without comparing items
+     * beyond one pass that checks the order.  When the allocator supports
+     * reserve (as PoolAllocator does), room for all n nodes is requested
+     * in one block up front.  The tree is left unchanged if this throws.
+     *
+     * @param first Start of a range of strictly increasing items.
+     * @param last End of the range.
+     * @throws std::runtime_error if the range is not strictly increasing.
+     */
+    template <typename ForwardIt>
+    void build_sorted(ForwardIt first, ForwardIt last);
+
+    /**
+     * @brief Replaces the contents with the items of an unsorted range.
+     *
+     * The items are copied, sorted and deduplicated (keeping the first of
+     * each run of equal items), then built as by build_sorted.
+     *
+     * @param first Start of the range.
+     * @param last End of the range.
+     */
+    template <typename InputIt>
+    void build(InputIt first, InputIt last);
+
+    /**
+     * @brief Same as build_sorted, with the work spread over a thread pool.
+     *
+     * The order check and the subtrees of more than cutoff items are forked
+     * onto pool; smaller subtrees are built sequentially.  Node storage is
+     * still taken from the allocator one batch per subtree under a lock, so
+     * the allocator need not be thread-safe.  The tree is left unchanged if
+     * this throws.
+     *
+     * @param first Start of a range of strictly increasing items.
+     * @param last End of the range.
+     * @param pool Pool running the subtree builds (optional).
+     * @param cutoff Subtrees of at most this many items are not split further (optional).
+     * @throws std::runtime_error if the range is not strictly increasing.
+     */
+    template <typename RandomIt>
+    void build_parallel(RandomIt first, RandomIt last, ThreadPool& pool = ThreadPool::instance(),
+                        std::size_t cutoff = parallelCutoff);
+
+    /**
+     * @brief Same as clear, with the work spread over a thread pool.
+     *
+     * When the tree is the only user of a PoolAllocator resource, the items
+     * are destroyed in parallel (not at all if that is trivial) and the
+     * whole pool is released at once instead of freeing node by node.
+     * Otherwise nodes must be returned to the allocator one at a time, and
+     * this is the same as clear.
+     *
+     * @param pool Pool running the subtree teardowns (optional).
+     * @param cutoff Subtrees of about this many items are not split further (optional).
+     */
+    void clear_parallel(ThreadPool& pool = ThreadPool::instance(), std::size_t cutoff = parallelCutoff);
+
+    /**
+     * @brief Moves the items into two trees: those less than key, and the rest.
+     *
+     * Nodes are relinked, not copied, and this tree is left empty with a
+     * fresh allocator of its own.  The cost is O(log n) only with RedBlack
+     * or AVL and OrderStatistics enabled.  Without OrderStatistics the
+     * smaller tree is counted to set the sizes, adding O(min(k, n - k))
+     * where k items are less than key, i.e. O(n) for a split near the
+     * median.
+     *
+     * Both trees share this tree's comparator and allocator, so they can be
+     * joined back cheaply.  With the default PoolAllocator that means both
+     * allocate from, and free to, one PoolResource, which is not
+     * thread-safe: the two trees (and whatever they are later joined into)
+     * must only be updated from one thread at a time.  To hand one of them
+     * to another thread, copy it, which gives the copy a pool of its own.
+     *
+     * @param key The pivot; it goes to the second tree if present.
+     * @return The pair (items < key, items >= key).
+     */
+    std::pair<BST, BST> split(const DataType& key);
+
+    /**
+     * @brief Concatenates two trees whose items do not interleave.
+     *
+     * The result uses left's allocator and comparator.  If right's allocator
+     * compares equal, its nodes are relinked and the cost is O(log n) with
+     * RedBlack or AVL; otherwise they are first copied into left's allocator
+     * in O(m).  Both arguments are left empty, each with a fresh allocator
+     * (see split for trees that share a pool).
+     *
+     * @param left Tree whose items all precede those of right.
+     * @param right Tree whose items all follow those of left.
+     * @return Tree holding the items of both.
+     * @throws std::runtime_error if the largest item of left is not less
+     *         than the smallest item of right.
+     */
+    static BST join(BST&& left, BST&& right);
+
+    /**
+     * @brief Set union, intersection and difference by splits and joins.
+     *
+     * Each works by recursively splitting a at the root of b and joining the
+     * results, relinking nodes and releasing the ones that are not kept.
+     * For trees of sizes m <= n this takes O(m log(n/m + 1)) with RedBlack or
+     * AVL, e.g. O(log n) to merge a handful of items into a large tree.
+     * Allocators and arguments are handled as by join; equal items are kept
+     * from a.  The recursion is as deep as b is high, so with Unbalanced,
+     * whose trees can be degenerate, both trees are instead flattened and
+     * merged in O(m + n), and the kept nodes relinked into a balanced tree.
+     * The comparator must not throw.
+     *
+     * @param a First operand.
+     * @param b Second operand.
+     * @return Tree holding the items in a or b, in a and b, or in a but not
+     *         b, respectively.
+     */
+    static BST set_union(BST&& a, BST&& b);
+    static BST set_intersection(BST&& a, BST&& b);
+    static BST set_difference(BST&& a, BST&& b);
+
     /**
      * @brief Checks if the binary search tree is empty.
      * 
@@ -87,6 +522,11 @@ public:
      */
     bool empty() const;
 
+    /**
+     * @brief Returns the number of items in the tree, in O(1).
+     */
+    std::size_t size() const;
+
     /**
      * @brief Searches for a given item in the binary search tree.
      * 
@@ -95,6 +535,58 @@ public:
      */
     bool search(const DataType& item) const;
 
+    /**
+     * @brief Searches for an item equivalent to key (transparent comparators only).
+     *
+     * @param key Any value comparable with DataType through Compare.
+     * @return true if such an item is found, false otherwise.
+     */
+    template <typename Key>
+        requires TransparentCompare<Compare>
+    bool search(const Key& key) const;
+
+    /**
+     * @brief Finds the given item in the binary search tree.
+     *
+     * @param item The item to search for.
+     * @return Iterator to the item, or end() if it is not in the tree.
+     */
+    const_iterator find(const DataType& item) const;
+
+    /**
+     * @brief Finds the item equivalent to key (transparent comparators only).
+     *
+     * @param key Any value comparable with DataType through Compare.
+     * @return Iterator to the item, or end() if there is none.
+     */
+    template <typename Key>
+        requires TransparentCompare<Compare>
+    const_iterator find(const Key& key) const;
+
+    /**
+     * @brief Searches for many items at once.
+     *
+     * The descents for a group of keys advance in lockstep, one level per
+     * round, and the next node of each is prefetched before the others are
+     * visited.  The cache misses of the group therefore overlap instead of
+     * being paid one after another, which pays off on trees larger than the
+     * last-level cache.
+     *
+     * @param keys The items to search for.
+     * @param found Receives, for each key, true if it is in the tree.
+     * @throws std::runtime_error if found and keys differ in size.
+     */
+    void search_batch(std::span<const DataType> keys, std::span<bool> found) const;
+
+    /**
+     * @brief Finds many items at once (see search_batch).
+     *
+     * @param keys The items to search for.
+     * @param found Receives, for each key, an iterator to it or end().
+     * @throws std::runtime_error if found and keys differ in size.
+     */
+    void find_batch(std::span<const DataType> keys, std::span<const_iterator> found) const;
+
     /**
      * Inserts a new item into the binary search tree.
      *
@@ -103,6 +595,64 @@ public:
      */
     void insert(const DataType& item);
 
+    /**
+     * Inserts a new item into the binary search tree without throwing on duplicates.
+     *
+     * @param item The item to be inserted.
+     * @return Iterator to the item in the tree, and true if it was inserted
+     *         or false if it was already present.
+     */
+    std::pair<const_iterator, bool> try_insert(const DataType& item);
+
+    /**
+     * Inserts a new item into the binary search tree, moving it into the node.
+     *
+     * @param item The item to be inserted.
+     * @throws std::runtime_error if item already in the tree.
+     */
+    void insert(DataType&& item);
+
+    /**
+     * Moves a new item into the binary search tree without throwing on duplicates.
+     *
+     * @param item The item to be inserted; left untouched if already present.
+     * @return Iterator to the item in the tree, and true if it was inserted
+     *         or false if it was already present.
+     */
+    std::pair<const_iterator, bool> try_insert(DataType&& item);
+
+    /**
+     * Constructs a new item in place inside its node and inserts it.
+     *
+     * The node is built before the tree is searched, so a duplicate costs one
+     * construction; it is then discarded without throwing.
+     *
+     * @param args Arguments forwarded to the DataType constructor.
+     * @return Iterator to the item in the tree, and true if it was inserted
+     *         or false if an equal item was already present.
+     */
+    template <typename... Args>
+    std::pair<const_iterator, bool> emplace(Args&&... args);
+
+    /**
+     * Inserts a batch of items sorted in increasing order, without throwing
+     * on duplicates.
+     *
+     * Each descent starts from the previous insertion point (a finger)
+     * rather than the root: it climbs only until the subtree above is known
+     * to contain the new item's position.  Keys that are close together
+     * therefore cost O(log d) steps for a gap of d items instead of a
+     * full O(log n) descent.  Items that are out of order fall back to a
+     * descent from the root, so the result is correct for any input.
+     *
+     * @param items The items to insert, in increasing order.
+     * @param inserted Receives, for each item, true if it was inserted or
+     *                 false if an equal item was already present.
+     * @return The number of items inserted.
+     * @throws std::runtime_error if inserted and items differ in size.
+     */
+    std::size_t insert_sorted_batch(std::span<const DataType> items, std::span<bool> inserted);
+
     /**
      * @brief Removes the specified item from the binary search tree.
      *
@@ -111,13 +661,21 @@ public:
      */
     void remove(const DataType& item);
 
+    /**
+     * @brief Removes the specified item, if present, without throwing.
+     *
+     * @param item The item to be removed.
+     * @return true if the item was removed, false if it was not in the tree.
+     */
+    bool try_erase(const DataType& item);
+
     /**
      * Performs an inorder traversal of the binary search tree and outputs the elements to the specified output stream.
      *
      * @param out The output stream to which the elements will be written.
      * @param separator String to separate elements (optional).
      */
-    void inorder(std::ostream& out, std::string separator = "  ");
+    void inorder(std::ostream &out, std::string_view separator = "  ");
 
     /**
      * Performs an preorder traversal of the binary search tree and outputs the elements to the specified output stream.
@@ -125,7 +683,7 @@ public:
      * @param out The output stream to which the elements will be written.
      * @param separator String to separate elements (optional).
      */
-    void preorder(std::ostream &out, std::string separator = "  ");
+    void preorder(std::ostream &out, std::string_view separator = "  ");
 
     /**
      * Performs an postorder traversal of the binary search tree and outputs the elements to the specified output stream.
@@ -133,7 +691,38 @@ public:
      * @param out The output stream to which the elements will be written.
      * @param separator String to separate elements (optional).
      */
-    void postorder(std::ostream &out, std::string separator = "  ");
+    void postorder(std::ostream &out, std::string_view separator = "  ");
+
+    /**
+     * Performs a level-by-level traversal of the binary search tree, top to
+     * bottom and left to right within a level, and outputs the elements to
+     * the specified output stream.
+     *
+     * @param out The output stream to which the elements will be written.
+     * @param separator String to separate elements (optional).
+     */
+    void levelorder(std::ostream &out, std::string_view separator = "  ");
+
+    /**
+     * @brief Calls visit on every item in inorder, preorder, postorder or
+     * level order respectively.
+     *
+     * The visitor is a template parameter, so the calls can be inlined.  A
+     * visitor returning bool stops the traversal early by returning false;
+     * the result of any other return type is ignored.  The tree must not be
+     * modified during the traversal.
+     *
+     * @param visit Callable invoked as visit(item) for each item.
+     * @return false if visit stopped the traversal early, true otherwise.
+     */
+    template <typename Visitor>
+    bool for_each_inorder(Visitor&& visit) const;
+    template <typename Visitor>
+    bool for_each_preorder(Visitor&& visit) const;
+    template <typename Visitor>
+    bool for_each_postorder(Visitor&& visit) const;
+    template <typename Visitor>
+    bool for_each_levelorder(Visitor&& visit) const;
 
     /**
      * @brief Prints the graphical representation of the binary search tree.
@@ -142,287 +731,2333 @@ public:
      */
     void graph(std::ostream &out);
 
-private:
     /**
-     * Searches for a specific item in the binary search tree.
-     * 
-     * @param item The item to search for.
-     * @param found A reference to a boolean variable that will be set to true if the item is found, false otherwise.
-     * @param locptr A reference to a pointer that will be set to the location of the found item, or nullptr if the item is not found.
-     * @param parent A reference to a pointer that will be set to the parent of the found item, or nullptr if the item is not found or if the found item is the root of the tree.
+     * @brief Writes the items in order through a BufferedWriter.
+     *
+     * Produces the same text as inorder with default stream flags, but
+     * formats numbers with std::to_chars into one large buffer and flushes
+     * only at buffer boundaries and at the end.  Meant for bulk dumps of
+     * large trees.
+     *
+     * @param out The output stream to which the elements will be written.
+     * @param separator String to separate elements (optional).
      */
-    void search2(const DataType& item, bool& found,
-        BinNodePointer& locptr, BinNodePointer& parent);
+    void write_inorder(std::ostream &out, std::string_view separator = "  ") const;
+
+    /**
+     * @brief Writes the graphical representation through a BufferedWriter.
+     *
+     * Produces the same text as graph with default stream flags.
+     *
+     * @param out The output stream to print the graph to.
+     */
+    void write_graph(std::ostream &out) const;
 
     /**
-     * @brief Recursively clears the binary search tree.
+     * @brief Returns an iterator to the smallest item (end() if the tree is empty).
      */
-    void clearAux(BinNodePointer subtreePtr);
+    const_iterator begin() const;
+
+    /**
+     * @brief Returns the past-the-end iterator.
+     */
+    const_iterator end() const;
+
+    /**
+     * @brief Same as begin().
+     */
+    const_iterator cbegin() const;
+
+    /**
+     * @brief Same as end().
+     */
+    const_iterator cend() const;
+
+    /**
+     * @brief Returns a reverse iterator to the largest item.
+     */
+    const_reverse_iterator rbegin() const;
 
     /**
-     * Performs an inorder traversal of the binary search tree rooted at subtreePtr
-     * and outputs the elements to the specified output stream.
+     * @brief Returns the past-the-end reverse iterator.
+     */
+    const_reverse_iterator rend() const;
+
+    /**
+     * @brief Finds the first item not less than the given item.
      *
-     * @param out The output stream to write the elements to.
-     * @param subtreePtr A pointer to the root of the subtree to traverse.
+     * @param item The item to compare against.
+     * @return Iterator to the first item >= item, or end() if there is none.
      */
-    void inorderAux(std::ostream &out, 
-                    BinNodePointer subtreePtr, 
-                    std::string separator = "  ");
+    const_iterator lower_bound(const DataType& item) const;
 
     /**
-     * Performs an preorder traversal of the binary search tree rooted at subtreePtr
-     * and outputs the elements to the specified output stream.
+     * @brief Finds the first item not less than key (transparent comparators only).
      *
-     * @param out The output stream to write the elements to.
-     * @param subtreePtr A pointer to the root of the subtree to traverse.
+     * @param key Any value comparable with DataType through Compare.
+     * @return Iterator to the first item >= key, or end() if there is none.
      */
-    void preorderAux(std::ostream &out, 
-                     BinNodePointer subtreePtr, 
-                     std::string separator = "  ");
+    template <typename Key>
+        requires TransparentCompare<Compare>
+    const_iterator lower_bound(const Key& key) const;
 
     /**
-     * Performs an postorder traversal of the binary search tree rooted at subtreePtr
-     * and outputs the elements to the specified output stream.
+     * @brief Finds the first item greater than the given item.
      *
-     * @param out The output stream to write the elements to.
-     * @param subtreePtr A pointer to the root of the subtree to traverse.
+     * @param item The item to compare against.
+     * @return Iterator to the first item > item, or end() if there is none.
      */
-    void postorderAux(std::ostream &out, 
-                      BinNodePointer subtreePtr, 
-                      std::string separator = "  ");
+    const_iterator upper_bound(const DataType& item) const;
 
     /**
-     * Recursively prints the binary search tree in a graphical format.
+     * @brief Finds the first item greater than key (transparent comparators only).
      *
-     * @param out The output stream to print the tree.
-     * @param indent The number of spaces to indent each level of the tree.
-     * @param subtreeRoot The root of the subtree to print.
+     * @param key Any value comparable with DataType through Compare.
+     * @return Iterator to the first item > key, or end() if there is none.
      */
-    void graphAux(std::ostream &out, int indent, BinNodePointer subtreeRoot);
+    template <typename Key>
+        requires TransparentCompare<Compare>
+    const_iterator upper_bound(const Key& key) const;
 
-    /***** Data Members *****/
-    BinNodePointer myRoot;
+    /**
+     * @brief Finds the range of items equal to the given item.
+     *
+     * @param item The item to compare against.
+     * @return Pair of lower_bound(item) and upper_bound(item); the range holds
+     *         at most one item since duplicates are not stored.
+     */
+    std::pair<const_iterator, const_iterator> equal_range(const DataType& item) const;
 
-}; // end of class template declaration
+    /**
+     * @brief Visits, in order, every item in the half-open interval [low, high).
+     *
+     * Only the path to low and the visited items themselves are touched, so
+     * the cost is O(h + k) for k visited items.
+     *
+     * @param low Smallest item to visit.
+     * @param high Items not less than high are not visited.
+     * @param visit Callable invoked as visit(item) for each item in range;
+     *              a visitor returning bool stops early by returning false.
+     * @return false if visit stopped early, true otherwise.
+     */
+    template <typename Visitor>
+    bool range(const DataType& low, const DataType& high, Visitor&& visit) const;
 
-//--- Definition of constructor
-template <typename DataType>
-inline BST<DataType>::BST()
-    : myRoot(nullptr)
-{}
+    /**
+     * @brief Counts the items less than the given item.
+     *
+     * Requires OrderStatistics.  O(h) for a tree of height h.
+     *
+     * @param item The item to compare against.
+     * @return The number of items < item, i.e. the 0-based position item
+     *         has or would have in order.
+     */
+    std::size_t rank(const DataType& item) const;
 
-//--- Definition of destructor
-template <typename DataType>
-BST<DataType>::~BST()
-{
-    clear();
-}
+    /**
+     * @brief Finds the k-th smallest item.
+     *
+     * Requires OrderStatistics.  O(h) for a tree of height h.
+     *
+     * @param k 0-based position in order.
+     * @return Iterator to the k-th smallest item, or end() if k >= size().
+     */
+    const_iterator select(std::size_t k) const;
+
+    /**
+     * @brief Counts the items in the half-open interval [low, high).
+     *
+     * Requires OrderStatistics.  O(h) for a tree of height h, independent
+     * of the number of items counted.
+     *
+     * @param low Smallest item to count.
+     * @param high Items not less than high are not counted.
+     * @return The number of items in range; 0 if high is not greater than low.
+     */
+    std::size_t count_range(const DataType& low, const DataType& high) const;
+
+    /**
+     * @brief Returns the aggregate of all items, in O(1).
+     *
+     * Requires an augmentation policy other than NoAugment.
+     *
+     * @return Augment::identity() if the tree is empty.
+     */
+    typename Augment::value_type aggregate() const;
+
+    /**
+     * @brief Aggregates, in order, the items in the half-open interval [low, high).
+     *
+     * Requires an augmentation policy other than NoAugment.  Combines the
+     * stored aggregates of the subtrees hanging off the paths to low and
+     * high, so the cost is O(h) for a tree of height h, independent of the
+     * number of items in range.
+     *
+     * @param low Smallest item to include.
+     * @param high Items not less than high are not included.
+     * @return The combined aggregate; Augment::identity() if the range is empty.
+     */
+    typename Augment::value_type aggregate(const DataType& low, const DataType& high) const;
+
+    /**
+     * @brief Exports the current items into an immutable snapshot.
+     *
+     * The snapshot stores the items contiguously in Eytzinger order and
+     * answers search and lower_bound without chasing pointers.  It does not
+     * follow later changes to the tree.
+     *
+     * @return The snapshot.
+     */
+    FrozenBST<DataType, Compare> freeze() const;
+
+    /**
+     * @brief Returns a copy of the allocator used by the tree.
+     */
+    allocator_type get_allocator() const;
+
+    /**
+     * @brief Returns a copy of the comparator used to order the items.
+     */
+    key_compare key_comp() const;
+
+private:
+    /**
+     * Allocates a node from the node allocator and constructs its item in place.
+     *
+     * @param args Arguments forwarded to the DataType constructor.
+     * @return Pointer to the new node.
+     */
+    template <typename... Args>
+    BinNodePointer createNode(Args&&... args);
+
+    /**
+     * Allocates a node from the node allocator as a copy of an existing node.
+     *
+     * @param source Node whose item and balancing data are copied.
+     * @return Pointer to the new, unlinked node.
+     */
+    BinNodePointer cloneNode(BinNodePointer source);
+
+    /**
+     * Copies the subtree rooted at sourceRoot into nodes from this tree's
+     * allocator, preserving its shape.  Runs in linear time and constant
+     * auxiliary space by walking the parent links.
+     *
+     * @param sourceRoot Root of the subtree to copy.
+     * @return Root of the copy (nullptr if sourceRoot is null).
+     */
+    BinNodePointer cloneTree(BinNodePointer sourceRoot);
+
+    /**
+     * Builds a minimal-height tree from the next count items of a sorted
+     * sequence, consuming them in order.  Recursion depth is O(log count).
+     *
+     * @param first Iterator to the next unused item; advanced past the items used.
+     * @param count Number of items in the subtree.
+     * @param depth Depth of the subtree root in the final tree.
+     * @param maxDepth Depth of the deepest level of the final tree.
+     * @return Root of the subtree (nullptr if count is zero).
+     */
+    template <typename ForwardIt>
+    BinNodePointer buildAux(ForwardIt& first, std::size_t count, int depth, int maxDepth);
+
+    /**
+     * Destroys a node and returns its storage to the node allocator.
+     *
+     * @param nodePtr The node to release.
+     */
+    void destroyNode(BinNodePointer nodePtr);
+
+    /**
+     * Descends to where item is or would be stored.
+     *
+     * @param item The item to look for.
+     * @param parent Set to the last node visited, i.e. the parent for a new
+     *               node holding item (nullptr if the tree is empty).
+     * @param left Set to whether the last step went left, i.e. the side of
+     *             parent a new node holding item goes on.
+     * @param start Node to start from; its subtree must be where item
+     *              belongs (optional, the root by default).
+     * @return Pointer to the node holding item, or nullptr if it is absent.
+     */
+    BinNodePointer findInsertPosition(const DataType& item, BinNodePointer& parent, bool& left,
+                                      BinNodePointer start = nullptr) const;
+
+    /**
+     * Inserts item unless an equal item is present; the node is only
+     * created (copying or moving item) once the item is known to be new.
+     */
+    template <typename Arg>
+    std::pair<const_iterator, bool> insertUnique(Arg&& item);
+
+    /**
+     * Links a new node below parent, on the side given by left (both as
+     * returned by findInsertPosition, so no comparison is repeated), and
+     * lets the balancing policy repair the tree.
+     */
+    void linkNode(BinNodePointer parent, bool left, BinNodePointer nodePtr);
+
+    /**
+     * Searches for a specific item in the binary search tree.
+     * 
+     * @param item The item to search for.
+     * @param found A reference to a boolean variable that will be set to true if the item is found, false otherwise.
+     * @param locptr A reference to a pointer that will be set to the location of the found item, or nullptr if the item is not found.
+     * @param parent A reference to a pointer that will be set to the parent of the found item, or nullptr if the item is not found or if the found item is the root of the tree.
+     */
+    void search2(const DataType& item, bool& found,
+        BinNodePointer& locptr, BinNodePointer& parent);
+
+    /**
+     * Compares key with an item using a single three-way comparison when the
+     * comparator and the types allow it (see the file comment).
+     *
+     * @param key The item (or comparable key) being looked for.
+     * @param data The item stored in the node being visited.
+     * @return An ordering: < 0 if key precedes data, > 0 if it follows, == 0 if equivalent.
+     */
+    template <typename Key>
+    auto compareKeys(const Key& key, const DataType& data) const;
+
+    /**
+     * Finds the node holding the item equivalent to key.
+     *
+     * @param key The item (or comparable key) to search for.
+     * @return Pointer to that node, or nullptr if there is none.
+     */
+    template <typename Key>
+    BinNodePointer findNode(const Key& key) const;
+
+    /**
+     * Runs the interleaved descents behind search_batch and find_batch.
+     *
+     * @param keys The items to search for.
+     * @param record Called as record(index, node) once per key, with the
+     *               node holding keys[index] or nullptr if it is absent.
+     */
+    template <typename Recorder>
+    void findBatchAux(std::span<const DataType> keys, Recorder&& record) const;
+
+    /**
+     * Hints that the given node will be read soon.
+     */
+    static void prefetchNode(BinNodePointer nodePtr);
+
+    /**
+     * Finds the node holding the first item not less than key.
+     *
+     * @param key The item (or comparable key) to compare against.
+     * @return Pointer to that node, or nullptr if every item is less than key.
+     */
+    template <typename Key>
+    BinNodePointer lowerBoundNode(const Key& key) const;
+
+    /**
+     * Finds the node holding the first item greater than key.
+     *
+     * @param key The item (or comparable key) to compare against.
+     * @return Pointer to that node, or nullptr if no item is greater than key.
+     */
+    template <typename Key>
+    BinNodePointer upperBoundNode(const Key& key) const;
+
+    /**
+     * @brief Releases every node of the subtree rooted at subtreePtr.
+     *
+     * Uses constant auxiliary space, so even a degenerate tree of millions
+     * of nodes is released without deep recursion.
+     */
+    void clearAux(BinNodePointer subtreePtr);
+
+    /**
+     * Calls visit on each item of the subtree rooted at subtreeRoot, in
+     * inorder, preorder or postorder respectively.
+     *
+     * Walks the parent links instead of recursing, so they use constant
+     * auxiliary space even on a degenerate tree.
+     *
+     * @param subtreeRoot A pointer to the root of the subtree to traverse.
+     * @param visit Callable invoked as visit(item); see visitItem.
+     * @return false if visit asked to stop early, true otherwise.
+     */
+    template <typename Visitor>
+    bool inorderAux(BinNodePointer subtreeRoot, Visitor& visit) const;
+    template <typename Visitor>
+    bool preorderAux(BinNodePointer subtreeRoot, Visitor& visit) const;
+    template <typename Visitor>
+    bool postorderAux(BinNodePointer subtreeRoot, Visitor& visit) const;
+
+    /**
+     * Finds the first node of a postorder traversal of a nonempty subtree:
+     * the leaf reached by going left whenever possible, else right.
+     */
+    static BinNodePointer firstPostorder(BinNodePointer subtreeRoot);
+
+    /**
+     * Invokes visit(item).  A visitor returning bool stops the traversal by
+     * returning false; any other return type never stops it.
+     *
+     * @return false if the traversal should stop, true otherwise.
+     */
+    template <typename Visitor>
+    static bool visitItem(Visitor& visit, const DataType& item);
+
+    /**
+     * Returns the number of nodes in the subtree rooted at subtreeRoot (0 if
+     * it is empty).  Requires OrderStatistics.
+     */
+    static std::size_t subtreeSize(BinNodePointer subtreeRoot);
+
+    /**
+     * Returns the aggregate of the subtree rooted at subtreeRoot
+     * (Augment::identity() if it is empty).
+     */
+    static typename Augment::value_type subtreeAggregate(BinNodePointer subtreeRoot);
+
+    /**
+     * Recursively prints the binary search tree in a graphical format.
+     *
+     * @param out The output stream to print the tree.
+     * @param indent The number of spaces to indent each level of the tree.
+     * @param subtreeRoot The root of the subtree to print.
+     */
+    void graphAux(std::ostream &out, int indent, BinNodePointer subtreeRoot);
+
+    /**
+     * Buffered counterpart of graphAux, used by write_graph.
+     */
+    void writeGraphAux(BufferedWriter& out, std::size_t indent, BinNodePointer subtreeRoot) const;
+
+    /**
+     * Moves the items of the tree rooted at root (whose parent link is
+     * ignored) into the trees less and greater, relinking nodes bottom-up
+     * with Balance::join along the search path for key.  equal receives the
+     * detached node holding key, or nullptr.
+     */
+    void splitAux(BinNodePointer root, const DataType& key,
+                  BinNodePointer& less, BinNodePointer& equal, BinNodePointer& greater);
+
+    /**
+     * Concatenates two trees whose items do not interleave, using the
+     * largest node of left as the middle node of Balance::join.
+     */
+    static BinNodePointer join2(BinNodePointer left, BinNodePointer right);
+
+    /**
+     * Recursive helpers of set_union, set_intersection and set_difference.
+     * They consume the trees rooted at a and b and release the nodes not
+     * kept, counting the items of b that are also in a.
+     */
+    BinNodePointer unionAux(BinNodePointer a, BinNodePointer b, std::size_t& common);
+    BinNodePointer intersectionAux(BinNodePointer a, BinNodePointer b, std::size_t& common);
+    BinNodePointer differenceAux(BinNodePointer a, BinNodePointer b, std::size_t& common);
+
+    /**
+     * Non-recursive counterpart of the helpers above, used with Unbalanced.
+     * Merges the nodes of a and b in order, keeping those only in a if
+     * keepOnlyA, those only in b if keepOnlyB and a's node of each item in
+     * both if keepBoth, and links the kept nodes as build_sorted would.
+     */
+    BinNodePointer mergeAux(BinNodePointer a, BinNodePointer b, bool keepOnlyA, bool keepOnlyB,
+                            bool keepBoth, std::size_t& common);
+
+    /**
+     * Takes the nodes of other, leaving it empty with a fresh allocator.
+     * They are relinked if the allocators compare equal and copied into
+     * this tree's allocator otherwise.
+     *
+     * @return Root of the taken nodes.
+     */
+    BinNodePointer adoptTree(BST& other);
+
+    /**
+     * Detaches a subtree from its former parent and lets the balancing
+     * policy fix up its root, so it can be used as a whole tree.
+     *
+     * @return subtreeRoot.
+     */
+    static BinNodePointer asTree(BinNodePointer subtreeRoot);
+
+    /***** State shared by the tasks of one build_parallel call *****/
+    struct ParallelBuild
+    {
+        ThreadPool& pool;
+        std::size_t cutoff;
+        int maxDepth;              // depth of the deepest level of the final tree
+        std::mutex allocMutex;     // serializes use of myAlloc
+    };
+
+    /**
+     * Checks that the count items at first are strictly increasing,
+     * forking halves of more than cutoff items onto pool.
+     */
+    template <typename RandomIt>
+    bool sortedParallelAux(RandomIt first, std::size_t count, ThreadPool& pool, std::size_t cutoff) const;
+
+    /**
+     * Builds the subtree holding the count items at first, with its root at
+     * the given depth of the final tree, in the shape buildAux would give
+     * it.  Larger subtrees fork their two halves; smaller ones take all
+     * their nodes from the allocator in one locked batch, construct the
+     * items, then link them.  Nothing is leaked if this throws.
+     *
+     * @return Root of the subtree (nullptr if count is zero).
+     */
+    template <typename RandomIt>
+    BinNodePointer buildParallelAux(ParallelBuild& build, RandomIt first, std::size_t count, int depth);
+
+    /**
+     * Links count constructed nodes, given in order, into the subtree
+     * buildAux would build from their items.
+     */
+    BinNodePointer linkBuiltAux(BinNodePointer* nodes, std::size_t count, int depth, int maxDepth);
+
+    /**
+     * Destroys the items of the subtree rooted at subtreePtr without
+     * returning the nodes to the allocator, in constant auxiliary space.
+     */
+    void destroyItemsAux(BinNodePointer subtreePtr);
+
+    /**
+     * Destroys the items of the subtree rooted at subtreePtr, forking the
+     * two subtrees of each node onto pool for the top forkLevels levels.
+     */
+    void destroyParallelAux(BinNodePointer subtreePtr, int forkLevels, ThreadPool& pool);
+
+    /***** Default cutoff of build_parallel and clear_parallel *****/
+    static constexpr std::size_t parallelCutoff = 16384;
+
+    /***** Data Members *****/
+    BinNodePointer myRoot;
+    std::size_t mySize;
+    NodeAllocator myAlloc;
+    [[no_unique_address]] Compare myCompare;
+
+}; // end of class template declaration
+
+//--- Definition of constructor
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BST(const Alloc& alloc)
+    : myRoot(nullptr), mySize(0), myAlloc(alloc), myCompare()
+{}
+
+//--- Definition of comparator constructor
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BST(const Compare& compare, const Alloc& alloc)
+    : myRoot(nullptr), mySize(0), myAlloc(alloc), myCompare(compare)
+{}
+
+//--- Definition of copy constructor
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BST(const BST& other)
+    : myRoot(nullptr), mySize(0),
+      myAlloc(NodeAllocTraits::select_on_container_copy_construction(other.myAlloc)),
+      myCompare(other.myCompare)
+{
+    myRoot = cloneTree(other.myRoot);
+    mySize = other.mySize;
+}
+
+//--- Definition of move constructor
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BST(BST&& other) noexcept
+    : myRoot(other.myRoot), mySize(other.mySize), myAlloc(std::move(other.myAlloc)),
+      myCompare(other.myCompare)
+{
+    other.myRoot = nullptr;
+    other.mySize = 0;
+}
+
+//--- Definition of assignment operator
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>& BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::operator=(const BST& other)
+{
+    if (this != &other)
+    {
+        if constexpr (NodeAllocTraits::propagate_on_container_copy_assignment::value)
+        {                                // nodes must come from other's allocator
+            clear();
+            myAlloc = other.myAlloc;
+            myRoot = cloneTree(other.myRoot);
+        }
+        else
+        {                                // copy first -- tree unchanged if it throws
+            BinNodePointer newRoot = cloneTree(other.myRoot);
+            clearAux(myRoot);
+            myRoot = newRoot;
+        }
+        mySize = other.mySize;
+        myCompare = other.myCompare;
+    }
+    return *this;
+}
+
+//--- Definition of move assignment
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>& BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::operator=(BST&& other)
+{
+    if (this != &other)
+    {
+        if (NodeAllocTraits::propagate_on_container_move_assignment::value ||
+            myAlloc == other.myAlloc)
+        {                                // other's nodes can be released by us
+            clear();
+            if constexpr (NodeAllocTraits::propagate_on_container_move_assignment::value)
+                myAlloc = std::move(other.myAlloc);
+            myRoot = other.myRoot;
+            mySize = other.mySize;
+            other.myRoot = nullptr;
+            other.mySize = 0;
+        }
+        else
+        {                                // nodes must come from our own allocator
+            BinNodePointer newRoot = cloneTree(other.myRoot);
+            clearAux(myRoot);
+            myRoot = newRoot;
+            mySize = other.mySize;
+            other.clear();
+        }
+        myCompare = other.myCompare;
+    }
+    return *this;
+}
+
+//--- Definition of destructor
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::~BST()
+{
+    clear();
+}
+
+//--- Definition of swap()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::swap(BST& other) noexcept
+{
+    using std::swap;
+    swap(myRoot, other.myRoot);
+    swap(mySize, other.mySize);
+    swap(myCompare, other.myCompare);
+    if constexpr (NodeAllocTraits::propagate_on_container_swap::value)
+        swap(myAlloc, other.myAlloc);
+}
+
+//--- Definition of swap() (non-member)
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void swap(BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>& a, BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>& b) noexcept
+{
+    a.swap(b);
+}
+
+//--- Definition of clear()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::clear()
+{
+    if constexpr (requires(NodeAllocator& alloc) { alloc.resource()->release(); })
+    {
+        // Nobody else allocates from the resource: drop it wholesale
+        if (myAlloc.resource().use_count() == 1)
+        {
+            if constexpr (!std::is_trivially_destructible_v<BinNode>)
+                destroyItemsAux(myRoot);
+            myAlloc.resource()->release();
+            myRoot = nullptr;
+            mySize = 0;
+            return;
+        }
+    }
+    clearAux(myRoot);
+    myRoot = nullptr;
+    mySize = 0;
+}
+
+//--- Definition of clearAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::clearAux(BinNodePointer subtreePtr)
+{
+    // Rotate left children up until the current node has none, turning the
+    // tree into a right-leaning vine that is freed as it is walked.
+    while (subtreePtr != nullptr)
+    {
+        BinNodePointer next;
+        if (subtreePtr->left != nullptr)
+        {                                // rotate right around subtreePtr
+            next = subtreePtr->left;
+            subtreePtr->left = next->right;
+            next->right = subtreePtr;
+        }
+        else
+        {                                // no left subtree -- free and move on
+            next = subtreePtr->right;
+            destroyNode(subtreePtr);
+        }
+        subtreePtr = next;
+    }
+}
+
+//--- Definition of build_sorted()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename ForwardIt>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::build_sorted(ForwardIt first, ForwardIt last)
+{
+    if (std::adjacent_find(first, last,
+                           [this](const DataType& a, const DataType& b)
+                           { return !myCompare(a, b); }) != last)
+        throw std::runtime_error("Items not strictly increasing");
+
+    std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+    int maxDepth = 0;                 // depth of the deepest level
+    for (std::size_t levelEnd = 1; levelEnd < count; levelEnd = 2 * levelEnd + 1)
+        ++maxDepth;
+
+    if constexpr (requires(NodeAllocator& alloc) { alloc.reserve(count); })
+        myAlloc.reserve(count);
+    BinNodePointer newRoot = buildAux(first, count, 0, maxDepth);
+    clearAux(myRoot);                 // not clear(): the new nodes share the pool
+    myRoot = newRoot;
+    mySize = count;
+}
+
+//--- Definition of build()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename InputIt>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::build(InputIt first, InputIt last)
+{
+    std::vector<DataType> items(first, last);
+    std::stable_sort(items.begin(), items.end(), myCompare);
+    items.erase(std::unique(items.begin(), items.end(),
+                            [this](const DataType& a, const DataType& b)
+                            { return !myCompare(a, b); }),
+                items.end());
+    build_sorted(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+}
+
+//--- Definition of build_parallel()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename RandomIt>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::build_parallel(RandomIt first, RandomIt last,
+                                                                                    ThreadPool& pool, std::size_t cutoff)
+{
+    cutoff = std::max<std::size_t>(cutoff, 1);
+    std::size_t count = static_cast<std::size_t>(last - first);
+    if (!sortedParallelAux(first, count, pool, cutoff))
+        throw std::runtime_error("Items not strictly increasing");
+
+    ParallelBuild build{pool, cutoff, 0, {}};
+    for (std::size_t levelEnd = 1; levelEnd < count; levelEnd = 2 * levelEnd + 1)
+        ++build.maxDepth;
+
+    if constexpr (requires(NodeAllocator& alloc) { alloc.reserve(count); })
+        myAlloc.reserve(count);
+    BinNodePointer newRoot = buildParallelAux(build, first, count, 0);
+    clearAux(myRoot);                 // not clear(): the new nodes share the pool
+    myRoot = newRoot;
+    mySize = count;
+}
+
+//--- Definition of clear_parallel()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::clear_parallel(ThreadPool& pool, std::size_t cutoff)
+{
+    if constexpr (requires(NodeAllocator& alloc) { alloc.resource()->release(); })
+    {
+        // Nobody else allocates from the resource: drop it wholesale
+        if (myAlloc.resource().use_count() == 1)
+        {
+            if constexpr (!std::is_trivially_destructible_v<BinNode>)
+            {
+                int forkLevels = 0;     // until subtrees hold about cutoff items
+                for (std::size_t items = size(); items > std::max<std::size_t>(cutoff, 1); items /= 2)
+                    ++forkLevels;
+                destroyParallelAux(myRoot, forkLevels, pool);
+            }
+            myAlloc.resource()->release();
+            myRoot = nullptr;
+            mySize = 0;
+            return;
+        }
+    }
+    (void)pool;
+    (void)cutoff;
+    clear();
+}
+
+//--- Definition of buildAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename ForwardIt>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::buildAux(ForwardIt& first, std::size_t count, int depth, int maxDepth)
+{
+    if (count == 0)
+        return nullptr;
+
+    std::size_t leftCount = (count - 1) / 2;
+    BinNodePointer leftPtr = buildAux(first, leftCount, depth + 1, maxDepth),
+                   nodePtr = nullptr,
+                   rightPtr = nullptr;
+    try
+    {
+        nodePtr = createNode(*first);
+        ++first;
+        rightPtr = buildAux(first, count - 1 - leftCount, depth + 1, maxDepth);
+    }
+    catch (...)
+    {
+        clearAux(leftPtr);
+        if (nodePtr != nullptr)
+            destroyNode(nodePtr);
+        throw;
+    }
+
+    nodePtr->left = leftPtr;
+    if (leftPtr != nullptr)
+        leftPtr->parent = nodePtr;
+    nodePtr->right = rightPtr;
+    if (rightPtr != nullptr)
+        rightPtr->parent = nodePtr;
+    nodePtr->update();
+    Balance::initBuilt(nodePtr, depth, maxDepth);
+    return nodePtr;
+}
+
+//--- Definition of sortedParallelAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename RandomIt>
+bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::sortedParallelAux(RandomIt first, std::size_t count,
+                                                                                       ThreadPool& pool,
+                                                                                       std::size_t cutoff) const
+{
+    auto notBefore = [this](const DataType& a, const DataType& b) { return !myCompare(a, b); };
+    if (count <= cutoff)
+        return std::adjacent_find(first, first + count, notBefore) == first + count;
+
+    std::size_t half = count / 2;
+    if (notBefore(first[half - 1], first[half]))
+        return false;
+    bool leftSorted = true,
+         rightSorted = true;
+    pool.parallel_invoke([&] { leftSorted = sortedParallelAux(first, half, pool, cutoff); },
+                         [&] { rightSorted = sortedParallelAux(first + half, count - half, pool, cutoff); });
+    return leftSorted && rightSorted;
+}
+
+//--- Definition of buildParallelAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename RandomIt>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::buildParallelAux(ParallelBuild& build, RandomIt first,
+                                                                                 std::size_t count, int depth)
+{
+    if (count == 0)
+        return nullptr;
+
+    if (count <= build.cutoff)
+    {                                   // small enough -- build it here
+        std::vector<BinNodePointer> nodes(count);
+        std::size_t allocated = 0,
+                    constructed = 0;
+        try
+        {
+            {
+                std::lock_guard<std::mutex> lock(build.allocMutex);
+                for (; allocated < count; ++allocated)
+                    nodes[allocated] = NodeAllocTraits::allocate(myAlloc, 1);
+            }
+            for (; constructed < count; ++constructed)
+                NodeAllocTraits::construct(myAlloc, nodes[constructed], std::in_place, first[constructed]);
+        }
+        catch (...)
+        {
+            for (std::size_t i = 0; i < constructed; ++i)
+                NodeAllocTraits::destroy(myAlloc, nodes[i]);
+            std::lock_guard<std::mutex> lock(build.allocMutex);
+            for (std::size_t i = 0; i < allocated; ++i)
+                NodeAllocTraits::deallocate(myAlloc, nodes[i], 1);
+            throw;
+        }
+        return linkBuiltAux(nodes.data(), count, depth, build.maxDepth);
+    }
+
+    // Large -- build the root here and the two subtrees in parallel
+    std::size_t leftCount = (count - 1) / 2;
+    BinNodePointer nodePtr;
+    {
+        std::lock_guard<std::mutex> lock(build.allocMutex);
+        nodePtr = NodeAllocTraits::allocate(myAlloc, 1);
+    }
+    try
+    {
+        NodeAllocTraits::construct(myAlloc, nodePtr, std::in_place, first[leftCount]);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(build.allocMutex);
+        NodeAllocTraits::deallocate(myAlloc, nodePtr, 1);
+        throw;
+    }
+
+    BinNodePointer leftPtr = nullptr,
+                   rightPtr = nullptr;
+    try
+    {
+        build.pool.parallel_invoke(
+            [&] { leftPtr = buildParallelAux(build, first, leftCount, depth + 1); },
+            [&] { rightPtr = buildParallelAux(build, first + (leftCount + 1), count - 1 - leftCount, depth + 1); });
+    }
+    catch (...)
+    {                                   // whichever half succeeded is released here
+        std::lock_guard<std::mutex> lock(build.allocMutex);
+        clearAux(leftPtr);
+        clearAux(rightPtr);
+        destroyNode(nodePtr);
+        throw;
+    }
+
+    nodePtr->left = leftPtr;
+    if (leftPtr != nullptr)
+        leftPtr->parent = nodePtr;
+    nodePtr->right = rightPtr;
+    rightPtr->parent = nodePtr;         // count > 1, so the right half is non-empty
+    nodePtr->update();
+    Balance::initBuilt(nodePtr, depth, build.maxDepth);
+    return nodePtr;
+}
+
+//--- Definition of linkBuiltAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::linkBuiltAux(BinNodePointer* nodes, std::size_t count,
+                                                                             int depth, int maxDepth)
+{
+    if (count == 0)
+        return nullptr;
+
+    std::size_t leftCount = (count - 1) / 2;
+    BinNodePointer nodePtr = nodes[leftCount],
+                   leftPtr = linkBuiltAux(nodes, leftCount, depth + 1, maxDepth),
+                   rightPtr = linkBuiltAux(nodes + leftCount + 1, count - 1 - leftCount, depth + 1, maxDepth);
+    nodePtr->left = leftPtr;
+    if (leftPtr != nullptr)
+        leftPtr->parent = nodePtr;
+    nodePtr->right = rightPtr;
+    if (rightPtr != nullptr)
+        rightPtr->parent = nodePtr;
+    nodePtr->update();
+    Balance::initBuilt(nodePtr, depth, maxDepth);
+    return nodePtr;
+}
+
+//--- Definition of destroyItemsAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::destroyItemsAux(BinNodePointer subtreePtr)
+{
+    // The vine walk of clearAux, destroying instead of freeing
+    while (subtreePtr != nullptr)
+    {
+        BinNodePointer next;
+        if (subtreePtr->left != nullptr)
+        {                                // rotate right around subtreePtr
+            next = subtreePtr->left;
+            subtreePtr->left = next->right;
+            next->right = subtreePtr;
+        }
+        else
+        {
+            next = subtreePtr->right;
+            NodeAllocTraits::destroy(myAlloc, subtreePtr);
+        }
+        subtreePtr = next;
+    }
+}
+
+//--- Definition of destroyParallelAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::destroyParallelAux(BinNodePointer subtreePtr,
+                                                                                        int forkLevels,
+                                                                                        ThreadPool& pool)
+{
+    if (subtreePtr == nullptr || forkLevels == 0)
+    {
+        destroyItemsAux(subtreePtr);
+        return;
+    }
+    BinNodePointer leftPtr = subtreePtr->left,
+                   rightPtr = subtreePtr->right;
+    NodeAllocTraits::destroy(myAlloc, subtreePtr);
+    pool.parallel_invoke([&] { destroyParallelAux(leftPtr, forkLevels - 1, pool); },
+                         [&] { destroyParallelAux(rightPtr, forkLevels - 1, pool); });
+}
+
+//--- Definition of split()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+std::pair<BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>, BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::split(const DataType& key)
+{
+    BST less(myCompare, get_allocator()),
+        notLess(myCompare, get_allocator());
+    BinNodePointer equal;
+    splitAux(myRoot, key, less.myRoot, equal, notLess.myRoot);
+    if (equal != nullptr)
+        notLess.myRoot = Balance::join(BinNodePointer(nullptr), equal, notLess.myRoot);
+
+    if (less.myRoot == nullptr)
+        notLess.mySize = mySize;
+    else if (notLess.myRoot == nullptr)
+        less.mySize = mySize;
+    else if constexpr (OrderStatistics)
+    {
+        less.mySize = subtreeSize(less.myRoot);
+        notLess.mySize = subtreeSize(notLess.myRoot);
+    }
+    else
+    {                                 // count whichever part is smaller
+        BinNodePointer x = BSTNodeOps::minimum(less.myRoot),
+                       y = BSTNodeOps::minimum(notLess.myRoot);
+        std::size_t count = 0;
+        while (x != nullptr && y != nullptr)
+        {
+            x = BSTNodeOps::successor(x);
+            y = BSTNodeOps::successor(y);
+            ++count;
+        }
+        less.mySize = x == nullptr ? count : mySize - count;
+        notLess.mySize = mySize - less.mySize;
+    }
+    myRoot = nullptr;
+    mySize = 0;
+    myAlloc = NodeAllocTraits::select_on_container_copy_construction(myAlloc);
+    return std::make_pair(std::move(less), std::move(notLess));
+}
+
+//--- Definition of join()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment> BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::join(BST&& left, BST&& right)
+{
+    if (left.myRoot != nullptr && right.myRoot != nullptr &&
+        !left.myCompare(BSTNodeOps::maximum(left.myRoot)->data,
+                        BSTNodeOps::minimum(right.myRoot)->data))
+        throw std::runtime_error("Trees overlap");
+
+    std::size_t size = left.mySize + right.mySize;
+    BST result(left.myCompare, left.get_allocator());
+    result.myRoot = result.adoptTree(left);
+    BinNodePointer rightRoot = result.adoptTree(right);
+    result.myRoot = asTree(join2(result.myRoot, rightRoot));
+    result.mySize = size;
+    return result;
+}
+
+//--- Definition of set_union()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment> BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::set_union(BST&& a, BST&& b)
+{
+    std::size_t sizeA = a.mySize,
+                sizeB = b.mySize,
+                common = 0;
+    BST result(a.myCompare, a.get_allocator());
+    result.myRoot = result.adoptTree(a);
+    BinNodePointer rootB = result.adoptTree(b);
+    if constexpr (std::is_same_v<Balance, Unbalanced>)
+        result.myRoot = asTree(result.mergeAux(result.myRoot, rootB, true, true, true, common));
+    else
+        result.myRoot = asTree(result.unionAux(result.myRoot, rootB, common));
+    result.mySize = sizeA + sizeB - common;
+    return result;
+}
+
+//--- Definition of set_intersection()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment> BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::set_intersection(BST&& a, BST&& b)
+{
+    std::size_t common = 0;
+    BST result(a.myCompare, a.get_allocator());
+    result.myRoot = result.adoptTree(a);
+    BinNodePointer rootB = result.adoptTree(b);
+    if constexpr (std::is_same_v<Balance, Unbalanced>)
+        result.myRoot = asTree(result.mergeAux(result.myRoot, rootB, false, false, true, common));
+    else
+        result.myRoot = asTree(result.intersectionAux(result.myRoot, rootB, common));
+    result.mySize = common;
+    return result;
+}
+
+//--- Definition of set_difference()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment> BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::set_difference(BST&& a, BST&& b)
+{
+    std::size_t sizeA = a.mySize,
+                common = 0;
+    BST result(a.myCompare, a.get_allocator());
+    result.myRoot = result.adoptTree(a);
+    BinNodePointer rootB = result.adoptTree(b);
+    if constexpr (std::is_same_v<Balance, Unbalanced>)
+        result.myRoot = asTree(result.mergeAux(result.myRoot, rootB, true, false, false, common));
+    else
+        result.myRoot = asTree(result.differenceAux(result.myRoot, rootB, common));
+    result.mySize = sizeA - common;
+    return result;
+}
+
+//--- Definition of empty()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::empty() const
+{
+    return myRoot == nullptr;
+}
+
+//--- Definition of size()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+std::size_t BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::size() const
+{
+    return mySize;
+}
+
+//--- Definition of search()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::search(const DataType& item) const
+{
+    return findNode(item) != nullptr;
+}
+
+//--- Definition of search() for transparent keys
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Key>
+    requires TransparentCompare<Compare>
+inline bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::search(const Key& key) const
+{
+    return findNode(key) != nullptr;
+}
+
+//--- Definition of find()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::find(const DataType& item) const
+{
+    return const_iterator(findNode(item), this);
+}
+
+//--- Definition of find() for transparent keys
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Key>
+    requires TransparentCompare<Compare>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::find(const Key& key) const
+{
+    return const_iterator(findNode(key), this);
+}
+
+//--- Definition of search_batch()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::search_batch(std::span<const DataType> keys,
+                                                          std::span<bool> found) const
+{
+    if (found.size() != keys.size())
+        throw std::runtime_error("Result span does not match the keys");
+    findBatchAux(keys, [&found](std::size_t index, BinNodePointer nodePtr)
+                 { found[index] = nodePtr != nullptr; });
+}
+
+//--- Definition of find_batch()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::find_batch(std::span<const DataType> keys,
+                                                        std::span<const_iterator> found) const
+{
+    if (found.size() != keys.size())
+        throw std::runtime_error("Result span does not match the keys");
+    findBatchAux(keys, [this, &found](std::size_t index, BinNodePointer nodePtr)
+                 { found[index] = const_iterator(nodePtr, this); });
+}
+
+//--- Definition of insert()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::insert(const DataType& item)
+{
+    if (!try_insert(item).second)
+        throw std::runtime_error("Item already in the tree");
+}
+
+//--- Definition of try_insert()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline std::pair<typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator, bool>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::try_insert(const DataType& item)
+{
+    return insertUnique(item);
+}
+
+//--- Definition of insert() for rvalues
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::insert(DataType&& item)
+{
+    if (!try_insert(std::move(item)).second)
+        throw std::runtime_error("Item already in the tree");
+}
+
+//--- Definition of try_insert() for rvalues
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline std::pair<typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator, bool>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::try_insert(DataType&& item)
+{
+    return insertUnique(std::move(item));
+}
+
+//--- Definition of emplace()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename... Args>
+std::pair<typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator, bool>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::emplace(Args&&... args)
+{
+    BinNodePointer nodePtr = createNode(std::forward<Args>(args)...),
+                   parent;
+    bool left;
+    BinNodePointer locptr = findInsertPosition(nodePtr->data, parent, left);
+    if (locptr != nullptr)
+    {                                 // equal item already present
+        destroyNode(nodePtr);
+        return std::make_pair(const_iterator(locptr, this), false);
+    }
+    linkNode(parent, left, nodePtr);
+    return std::make_pair(const_iterator(nodePtr, this), true);
+}
+
+//--- Definition of insert_sorted_batch()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+std::size_t BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::insert_sorted_batch(std::span<const DataType> items,
+                                                                        std::span<bool> inserted)
+{
+    if (inserted.size() != items.size())
+        throw std::runtime_error("Result span does not match the items");
+
+    std::size_t count = 0;
+    BinNodePointer finger = nullptr;  // node holding the previous item
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        const DataType& item = items[i];
+        BinNodePointer start = nullptr;
+        if (finger != nullptr && myCompare(finger->data, item))
+        {
+            // Climb until we leave a left subtree whose parent is not less
+            // than item: item belongs in that parent's subtree.  Climbing
+            // out of a right subtree never needs a comparison.
+            start = finger;
+            while (start != nullptr)
+            {
+                BinNodePointer parent = start->parent;
+                if (parent != nullptr && start == parent->left &&
+                    !myCompare(parent->data, item))
+                {
+                    start = parent;
+                    break;
+                }
+                start = parent;                // null once past the root
+            }
+        }
+
+        BinNodePointer parent;
+        bool left;
+        BinNodePointer locptr = findInsertPosition(item, parent, left, start);
+        if (locptr == nullptr)
+        {
+            locptr = createNode(item);
+            linkNode(parent, left, locptr);
+            inserted[i] = true;
+            ++count;
+        }
+        else
+            inserted[i] = false;
+        finger = locptr;
+    }
+    return count;
+}
+
+//--- Definition of remove()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::remove(const DataType& item)
+{
+    if (!try_erase(item))
+        throw std::runtime_error("Item not in the BST");
+}
+
+//--- Definition of try_erase()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::try_erase(const DataType& item)
+{
+    bool found;                      // signals if item is found
+    BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+        x,                            // points to node containing
+        parent;                       //    "    " parent of x
+    search2(item, found, x, parent);
+
+    if (!found)
+        return false;
+    //else
+    // Relink x's children (or its inorder successor) into its place
+    // and let the balancing policy repair the tree
+    Balance::erase(myRoot, x);
+    destroyNode(x);
+    --mySize;
+    return true;
+}
+
+//--- Definition of inorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::inorder(std::ostream &out, std::string_view separator)
+{
+    for_each_inorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of preorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::preorder(std::ostream &out, std::string_view separator)
+{
+    for_each_preorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of postorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::postorder(std::ostream &out, std::string_view separator)
+{
+    for_each_postorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of levelorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::levelorder(std::ostream &out, std::string_view separator)
+{
+    for_each_levelorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of for_each_inorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+inline bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::for_each_inorder(Visitor&& visit) const
+{
+    return inorderAux(myRoot, visit);
+}
+
+//--- Definition of for_each_preorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+inline bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::for_each_preorder(Visitor&& visit) const
+{
+    return preorderAux(myRoot, visit);
+}
+
+//--- Definition of for_each_postorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+inline bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::for_each_postorder(Visitor&& visit) const
+{
+    return postorderAux(myRoot, visit);
+}
+
+//--- Definition of for_each_levelorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::for_each_levelorder(Visitor&& visit) const
+{
+    if (myRoot == nullptr)
+        return true;
+    std::vector<BinNodePointer> level{myRoot},
+                                next;
+    while (!level.empty())
+    {
+        for (BinNodePointer node : level)
+        {
+            if (!visitItem(visit, node->data))
+                return false;
+            if (node->left != nullptr)
+                next.push_back(node->left);
+            if (node->right != nullptr)
+                next.push_back(node->right);
+        }
+        level.swap(next);
+        next.clear();
+    }
+    return true;
+}
+
+//--- Definition of graph()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::graph(std::ostream &out)
+{
+    graphAux(out, 0, myRoot);
+    out.flush();
+}
+
+//--- Definition of write_inorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::write_inorder(std::ostream &out, std::string_view separator) const
+{
+    BufferedWriter writer(out);
+    for_each_inorder([&](const DataType& item)
+    {
+        writer.write(item);
+        writer.write(separator);
+    });
+}
+
+//--- Definition of write_graph()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::write_graph(std::ostream &out) const
+{
+    BufferedWriter writer(out);
+    writeGraphAux(writer, 0, myRoot);
+}
+
+//--- Definition of begin()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::begin() const
+{
+    if (myRoot == nullptr)
+        return end();
+    return const_iterator(BSTNodeOps::minimum(myRoot), this);
+}
+
+//--- Definition of end()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::end() const
+{
+    return const_iterator(nullptr, this);
+}
+
+//--- Definition of cbegin()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::cbegin() const
+{
+    return begin();
+}
+
+//--- Definition of cend()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::cend() const
+{
+    return end();
+}
 
-//--- Definition of clear()
-template <typename DataType>
-void BST<DataType>::clear()
+//--- Definition of rbegin()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_reverse_iterator BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::rbegin() const
 {
-    clearAux(myRoot);
-    myRoot = nullptr;
+    return const_reverse_iterator(end());
 }
 
-//--- Definition of clearAux()
-template <typename DataType>
-void BST<DataType>::clearAux(BinNodePointer subtreePtr)
+//--- Definition of rend()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_reverse_iterator BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::rend() const
 {
-    if (subtreePtr != nullptr)
-    {
-        clearAux(subtreePtr->left);
-        clearAux(subtreePtr->right);
-        delete subtreePtr;
-    }
+    return const_reverse_iterator(begin());
 }
 
-//--- Definition of empty()
-template <typename DataType>
-inline bool BST<DataType>::empty() const
+//--- Definition of lower_bound()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::lower_bound(const DataType& item) const
 {
-    return myRoot == nullptr;
+    return const_iterator(lowerBoundNode(item), this);
 }
 
-//--- Definition of search()
-template <typename DataType>
-bool BST<DataType>::search(const DataType& item) const
+//--- Definition of lower_bound() for transparent keys
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Key>
+    requires TransparentCompare<Compare>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::lower_bound(const Key& key) const
 {
-    bool found = false;
-    // add code here
-    // return appropriate value
-    return found;
+    return const_iterator(lowerBoundNode(key), this);
 }
 
-//--- Definition of insert()
-template <class DataType>
-inline void BST<DataType>::insert(const DataType& item)
+//--- Definition of upper_bound()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::upper_bound(const DataType& item) const
 {
-    BST<DataType>::BinNodePointer
-        locptr = myRoot,   // search pointer
-        parent = nullptr;  // pointer to parent of current node
-    bool found = false;     // indicates if item already in BST
-    while (!found && locptr != nullptr)
+    return const_iterator(upperBoundNode(item), this);
+}
+
+//--- Definition of upper_bound() for transparent keys
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Key>
+    requires TransparentCompare<Compare>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::upper_bound(const Key& key) const
+{
+    return const_iterator(upperBoundNode(key), this);
+}
+
+//--- Definition of equal_range()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+std::pair<typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator,
+          typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::equal_range(const DataType& item) const
+{
+    const_iterator first = lower_bound(item),
+                   last = first;
+    if (last != end() && !myCompare(item, *last))  // item itself is present
+        ++last;
+    return std::make_pair(first, last);
+}
+
+//--- Definition of range()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::range(const DataType& low, const DataType& high,
+                                          Visitor&& visit) const
+{
+    for (BinNodePointer locptr = lowerBoundNode(low);
+         locptr != nullptr && myCompare(locptr->data, high);
+         locptr = BSTNodeOps::successor(locptr))
+    {
+        if (!visitItem(visit, locptr->data))
+            return false;
+    }
+    return true;
+}
+
+//--- Definition of rank()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+std::size_t BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::rank(const DataType& item) const
+{
+    static_assert(OrderStatistics, "rank requires a BST with OrderStatistics enabled");
+    std::size_t count = 0;            // items known to be less than item
+    BinNodePointer locptr = myRoot;
+    while (locptr != nullptr)
     {
-        parent = locptr;
-        if (item < locptr->data)       // descend left
+        auto order = compareKeys(item, locptr->data);
+        if (order < 0)                 // descend left
             locptr = locptr->left;
-        else if (locptr->data < item)  // descend right
+        else if (order > 0)            // skip left subtree and node, descend right
+        {
+            count += subtreeSize(locptr->left) + 1;
             locptr = locptr->right;
+        }
         else                           // item found
-            found = true;
+            return count + subtreeSize(locptr->left);
     }
-    if (!found)
-    {                                 // construct node containing item
-        locptr = new BST<DataType>::BinNode(item);
-        if (parent == nullptr)        // empty tree
-            myRoot = locptr;
-        else if (item < parent->data)  // insert to left of parent
-            parent->left = locptr;
-        else                           // insert to right of parent
-            parent->right = locptr;
+    return count;
+}
+
+//--- Definition of select()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::select(std::size_t k) const
+{
+    static_assert(OrderStatistics, "select requires a BST with OrderStatistics enabled");
+    BinNodePointer locptr = myRoot;
+    while (locptr != nullptr)
+    {
+        std::size_t leftSize = subtreeSize(locptr->left);
+        if (k < leftSize)
+            locptr = locptr->left;
+        else if (k > leftSize)
+        {
+            k -= leftSize + 1;
+            locptr = locptr->right;
+        }
+        else
+            return const_iterator(locptr, this);
+    }
+    return end();
+}
+
+//--- Definition of count_range()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+std::size_t BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::count_range(const DataType& low,
+                                                                                 const DataType& high) const
+{
+    static_assert(OrderStatistics, "count_range requires a BST with OrderStatistics enabled");
+    if (!myCompare(low, high))
+        return 0;
+    return rank(high) - rank(low);
+}
+
+//--- Definition of aggregate()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename Augment::value_type BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::aggregate() const
+{
+    static_assert(!std::is_same_v<Augment, NoAugment>, "aggregate requires an augmentation policy");
+    return subtreeAggregate(myRoot);
+}
+
+//--- Definition of aggregate() (range)
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename Augment::value_type BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::aggregate(const DataType& low,
+                                                                                                       const DataType& high) const
+{
+    static_assert(!std::is_same_v<Augment, NoAugment>, "aggregate requires an augmentation policy");
+
+    // Descend to the highest node in range, where the paths to low and high part
+    BinNodePointer top = myRoot;
+    while (top != nullptr)
+    {
+        if (myCompare(top->data, low))
+            top = top->right;
+        else if (!myCompare(top->data, high))
+            top = top->left;
+        else
+            break;
+    }
+    if (top == nullptr)
+        return Augment::identity();
+
+    // Along the path to low, each node in range comes with its right
+    // subtree, ahead of everything collected so far.
+    typename Augment::value_type lowPart = Augment::identity();
+    for (BinNodePointer locptr = top->left; locptr != nullptr; )
+    {
+        if (myCompare(locptr->data, low))
+            locptr = locptr->right;
+        else
+        {
+            lowPart = Augment::combine(Augment::combine(Augment::lift(locptr->data),
+                                                        subtreeAggregate(locptr->right)),
+                                       lowPart);
+            locptr = locptr->left;
+        }
+    }
+
+    // Symmetrically toward high, each node in range comes after its left subtree
+    typename Augment::value_type highPart = Augment::identity();
+    for (BinNodePointer locptr = top->right; locptr != nullptr; )
+    {
+        if (!myCompare(locptr->data, high))
+            locptr = locptr->left;
+        else
+        {
+            highPart = Augment::combine(highPart,
+                                        Augment::combine(subtreeAggregate(locptr->left),
+                                                         Augment::lift(locptr->data)));
+            locptr = locptr->right;
+        }
     }
+    return Augment::combine(Augment::combine(lowPart, Augment::lift(top->data)), highPart);
+}
+
+//--- Definition of freeze()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline FrozenBST<DataType, Compare> BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::freeze() const
+{
+    return FrozenBST<DataType, Compare>(begin(), end(), myCompare);
+}
+
+//--- Definition of get_allocator()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::allocator_type BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::get_allocator() const
+{
+    return allocator_type(myAlloc);
+}
+
+//--- Definition of key_comp()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::key_compare BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::key_comp() const
+{
+    return myCompare;
+}
+
+//--- Definition of compareKeys()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Key>
+inline auto BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::compareKeys(const Key& key, const DataType& data) const
+{
+    if constexpr (ThreeWayCompare<Compare, Key, DataType>)
+        return myCompare.compare(key, data);
+    else if constexpr ((std::is_same_v<Compare, std::less<>> ||
+                        std::is_same_v<Compare, std::less<DataType>>) &&
+                       std::three_way_comparable_with<Key, DataType>)
+        return key <=> data;
+    else if (myCompare(key, data))
+        return std::weak_ordering::less;
+    else if (myCompare(data, key))
+        return std::weak_ordering::greater;
     else
+        return std::weak_ordering::equivalent;
+}
+
+//--- Definition of findNode()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Key>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::findNode(const Key& key) const
+{
+    BinNodePointer locptr = myRoot;
+    while (locptr != nullptr)
     {
-        throw std::runtime_error("Item already in the tree");
+        auto order = compareKeys(key, locptr->data);
+        if (order < 0)                 // descend left
+            locptr = locptr->left;
+        else if (order > 0)            // descend right
+            locptr = locptr->right;
+        else                           // item found
+            return locptr;
     }
+    return nullptr;
 }
 
-//--- Definition of remove()
-template <class DataType>
-void BST<DataType>::remove(const DataType& item)
+//--- Definition of findBatchAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Recorder>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::findBatchAux(std::span<const DataType> keys,
+                                                          Recorder&& record) const
 {
-    bool found;                      // signals if item is found
-    BST<DataType>::BinNodePointer
-        x,                            // points to node containing
-        parent;                       //    "    " parent of x and xSucc
-    search2(item, found, x, parent);
+    // Enough descents in flight to cover the memory latency, few enough
+    // for the cursors to stay in registers and L1
+    constexpr std::size_t GROUP_SIZE = 16;
 
-    if (!found)
+    if (myRoot == nullptr)
     {
-        throw std::runtime_error("Item not in the BST");
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            record(i, nullptr);
         return;
     }
-    //else
-    if (x->left != nullptr && x->right != nullptr)
-    {                                // node has 2 children
-        // Find x's inorder successor and its parent
-        BST<DataType>::BinNodePointer xSucc = x->right;
-        parent = x;
-        while (xSucc->left != nullptr)       // descend left
-        {
-            parent = xSucc;
-            xSucc = xSucc->left;
-        }
-
-        // Move contents of xSucc to x and change x
-        // to point to successor, which will be removed.
-        x->data = xSucc->data;
-        x = xSucc;
-    } // end if node has 2 children
-
-    // Now proceed with case where node has 0 or 1 child
-    BST<DataType>::BinNodePointer
-        subtree = x->left;             // pointer to a subtree of x
-    if (subtree == nullptr)
-        subtree = x->right;
-    if (parent == nullptr)            // root being removed
-        myRoot = subtree;
-    else if (parent->left == x)       // left child of parent
-        parent->left = subtree;
-    else                              // right child of parent
-        parent->right = subtree;
-    delete x;
+
+    for (std::size_t base = 0; base < keys.size(); base += GROUP_SIZE)
+    {
+        std::size_t active = std::min(GROUP_SIZE, keys.size() - base);
+        BinNodePointer cursor[GROUP_SIZE];   // current node of each descent
+        std::size_t live[GROUP_SIZE];        // descents still running
+        for (std::size_t i = 0; i < active; ++i)
+        {
+            cursor[i] = myRoot;
+            live[i] = i;
+        }
+
+        // Advance every running descent by one level per round
+        while (active > 0)
+        {
+            std::size_t kept = 0;
+            for (std::size_t j = 0; j < active; ++j)
+            {
+                std::size_t i = live[j];
+                BinNodePointer locptr = cursor[i];
+                auto order = compareKeys(keys[base + i], locptr->data);
+                if (order == 0)              // item found
+                {
+                    record(base + i, locptr);
+                    continue;
+                }
+                locptr = order < 0 ? locptr->left : locptr->right;
+                if (locptr == nullptr)       // fell off the tree
+                {
+                    record(base + i, nullptr);
+                    continue;
+                }
+                prefetchNode(locptr);
+                cursor[i] = locptr;
+                live[kept++] = i;
+            }
+            active = kept;
+        }
+    }
 }
 
-//--- Definition of inorder()
-template <class DataType>
-inline void BST<DataType>::inorder(std::ostream &out, std::string separator)
+//--- Definition of prefetchNode()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::prefetchNode(BinNodePointer nodePtr)
 {
-    inorderAux(out, myRoot, separator);
+#if defined(__GNUC__)
+    __builtin_prefetch(nodePtr);
+#else
+    (void)nodePtr;
+#endif
+}
+
+//--- Definition of lowerBoundNode()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Key>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::lowerBoundNode(const Key& key) const
+{
+    BinNodePointer locptr = myRoot,
+                   result = nullptr;  // smallest node found so far with data >= key
+    while (locptr != nullptr)
+    {
+        if (myCompare(locptr->data, key))
+            locptr = locptr->right;
+        else
+        {
+            result = locptr;
+            locptr = locptr->left;
+        }
+    }
+    return result;
 }
 
-template <class DataType>
-inline void BST<DataType>::preorder(std::ostream &out, std::string separator)
+//--- Definition of upperBoundNode()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Key>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::upperBoundNode(const Key& key) const
 {
-    // add code here
+    BinNodePointer locptr = myRoot,
+                   result = nullptr;  // smallest node found so far with data > key
+    while (locptr != nullptr)
+    {
+        if (myCompare(key, locptr->data))
+        {
+            result = locptr;
+            locptr = locptr->left;
+        }
+        else
+            locptr = locptr->right;
+    }
+    return result;
 }
 
-template <class DataType>
-inline void BST<DataType>::postorder(std::ostream &out, std::string separator)
+//--- Definition of createNode()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename... Args>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::createNode(Args&&... args)
 {
-   // add code here
+    BinNodePointer nodePtr = NodeAllocTraits::allocate(myAlloc, 1);
+    try
+    {
+        NodeAllocTraits::construct(myAlloc, nodePtr, std::in_place, std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        NodeAllocTraits::deallocate(myAlloc, nodePtr, 1);
+        throw;
+    }
+    return nodePtr;
 }
 
-//--- Definition of graph()
-template <class DataType>
-inline void BST<DataType>::graph(std::ostream &out)
+//--- Definition of cloneNode()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::cloneNode(BinNodePointer source)
 {
-    graphAux(out, 0, myRoot);
+    BinNodePointer nodePtr = NodeAllocTraits::allocate(myAlloc, 1);
+    try
+    {
+        NodeAllocTraits::construct(myAlloc, nodePtr, *source);
+    }
+    catch (...)
+    {
+        NodeAllocTraits::deallocate(myAlloc, nodePtr, 1);
+        throw;
+    }
+    return nodePtr;
 }
 
-//--- Definition of search2()
-template <class DataType>
-void BST<DataType>::search2(const DataType& item, bool& found,
-    BST<DataType>::BinNodePointer& locptr,
-    BST<DataType>::BinNodePointer& parent)
+//--- Definition of cloneTree()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::cloneTree(BinNodePointer sourceRoot)
+{
+    if (sourceRoot == nullptr)
+        return nullptr;
+
+    BinNodePointer copyRoot = cloneNode(sourceRoot);
+    try
+    {
+        // Walk the source in preorder with src; copy mirrors its position.
+        // A child is copied on the way down, so once both copies exist the
+        // walk climbs back up.
+        BinNodePointer src = sourceRoot,
+                       copy = copyRoot;
+        while (true)
+        {
+            if (src->left != nullptr && copy->left == nullptr)
+            {                            // descend left
+                copy->left = cloneNode(src->left);
+                copy->left->parent = copy;
+                src = src->left;
+                copy = copy->left;
+            }
+            else if (src->right != nullptr && copy->right == nullptr)
+            {                            // descend right
+                copy->right = cloneNode(src->right);
+                copy->right->parent = copy;
+                src = src->right;
+                copy = copy->right;
+            }
+            else if (src == sourceRoot)  // whole subtree copied
+                break;
+            else
+            {                            // climb back up
+                src = src->parent;
+                copy = copy->parent;
+            }
+        }
+    }
+    catch (...)
+    {
+        clearAux(copyRoot);
+        throw;
+    }
+    return copyRoot;
+}
+
+//--- Definition of destroyNode()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::destroyNode(BinNodePointer nodePtr)
+{
+    NodeAllocTraits::destroy(myAlloc, nodePtr);
+    NodeAllocTraits::deallocate(myAlloc, nodePtr, 1);
+}
+
+//--- Definition of findInsertPosition()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::findInsertPosition(const DataType& item, BinNodePointer& parent,
+                                                           bool& left, BinNodePointer start) const
+{
+    BinNodePointer locptr = start != nullptr ? start : myRoot;   // search pointer
+    parent = nullptr;                 // pointer to parent of current node
+    left = false;
+    while (locptr != nullptr)
+    {
+        auto order = compareKeys(item, locptr->data);
+        if (order < 0)                 // descend left
+        {
+            parent = locptr;
+            locptr = locptr->left;
+            left = true;
+        }
+        else if (order > 0)            // descend right
+        {
+            parent = locptr;
+            locptr = locptr->right;
+            left = false;
+        }
+        else                           // item found
+            return locptr;
+    }
+    return nullptr;
+}
+
+//--- Definition of insertUnique()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Arg>
+std::pair<typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::const_iterator, bool>
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::insertUnique(Arg&& item)
+{
+    BinNodePointer parent;
+    bool left;
+    BinNodePointer locptr = findInsertPosition(item, parent, left);
+    if (locptr != nullptr)            // item already in BST
+        return std::make_pair(const_iterator(locptr, this), false);
+
+    // construct node containing item
+    locptr = createNode(std::forward<Arg>(item));
+    linkNode(parent, left, locptr);
+    return std::make_pair(const_iterator(locptr, this), true);
+}
+
+//--- Definition of linkNode()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::linkNode(BinNodePointer parent, bool left,
+                                                                                  BinNodePointer nodePtr)
+{
+    // link to the side of parent the descent ended on
+    BSTNodeOps::attach(myRoot, parent, nodePtr, left);
+    Balance::insertFixup(myRoot, nodePtr);
+    ++mySize;
+}
+
+//--- Definition of splitAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::splitAux(BinNodePointer root, const DataType& key,
+                                                                    BinNodePointer& less, BinNodePointer& equal,
+                                                                    BinNodePointer& greater)
+{
+    less = equal = greater = nullptr;
+
+    // Find the deepest node on the search path that still has to be moved
+    BinNodePointer locptr = nullptr,
+                   next = root;
+    bool wentLeft = false;            // direction taken at locptr
+    while (next != nullptr)
+    {
+        auto order = compareKeys(key, next->data);
+        if (order == 0)
+        {
+            equal = next;
+            less = equal->left;
+            greater = equal->right;
+            break;
+        }
+        locptr = next;
+        wentLeft = order < 0;
+        next = wentLeft ? next->left : next->right;
+    }
+
+    // Climbing back, each node joins the side it belongs to together with
+    // its subtree off the path; the pieces below are already on that side.
+    while (locptr != nullptr)
+    {
+        BinNodePointer up = locptr == root ? nullptr : locptr->parent;
+        bool upWentLeft = up != nullptr && up->left == locptr;
+        if (wentLeft)
+            greater = Balance::join(greater, locptr, locptr->right);
+        else
+            less = Balance::join(locptr->left, locptr, less);
+        locptr = up;
+        wentLeft = upWentLeft;
+    }
+
+    less = asTree(less);
+    greater = asTree(greater);
+}
+
+//--- Definition of join2()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::join2(BinNodePointer left, BinNodePointer right)
+{
+    if (left == nullptr)
+        return right;
+    if (right == nullptr)
+        return left;
+    left->parent = nullptr;
+    BinNodePointer mid = BSTNodeOps::maximum(left);
+    Balance::erase(left, mid);
+    return Balance::join(left, mid, right);
+}
+
+//--- Definition of unionAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::unionAux(BinNodePointer a, BinNodePointer b, std::size_t& common)
+{
+    if (a == nullptr)
+        return b;
+    if (b == nullptr)
+        return a;
+    BinNodePointer bLeft = b->left,
+                   bRight = b->right,
+                   aLess, aEqual, aGreater;
+    splitAux(a, b->data, aLess, aEqual, aGreater);
+    if (aEqual != nullptr)
+    {                                 // keep a's item, drop b's node
+        BinNodePointer merged = Balance::join(unionAux(aLess, bLeft, common), aEqual,
+                                              unionAux(aGreater, bRight, common));
+        destroyNode(b);
+        ++common;
+        return merged;
+    }
+    return Balance::join(unionAux(aLess, bLeft, common), b,
+                         unionAux(aGreater, bRight, common));
+}
+
+//--- Definition of intersectionAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::intersectionAux(BinNodePointer a, BinNodePointer b, std::size_t& common)
+{
+    if (a == nullptr || b == nullptr)
+    {
+        clearAux(a);
+        clearAux(b);
+        return nullptr;
+    }
+    BinNodePointer bLeft = b->left,
+                   bRight = b->right,
+                   aLess, aEqual, aGreater;
+    splitAux(a, b->data, aLess, aEqual, aGreater);
+    destroyNode(b);
+    BinNodePointer left = intersectionAux(aLess, bLeft, common),
+                   right = intersectionAux(aGreater, bRight, common);
+    if (aEqual == nullptr)
+        return join2(left, right);
+    ++common;
+    return Balance::join(left, aEqual, right);
+}
+
+//--- Definition of differenceAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::differenceAux(BinNodePointer a, BinNodePointer b, std::size_t& common)
+{
+    if (a == nullptr || b == nullptr)
+    {
+        clearAux(b);
+        return a;
+    }
+    BinNodePointer bLeft = b->left,
+                   bRight = b->right,
+                   aLess, aEqual, aGreater;
+    splitAux(a, b->data, aLess, aEqual, aGreater);
+    destroyNode(b);
+    if (aEqual != nullptr)
+    {
+        destroyNode(aEqual);
+        ++common;
+    }
+    return join2(differenceAux(aLess, bLeft, common),
+                 differenceAux(aGreater, bRight, common));
+}
+
+//--- Definition of mergeAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::mergeAux(BinNodePointer a, BinNodePointer b,
+                                                                         bool keepOnlyA, bool keepOnlyB,
+                                                                         bool keepBoth, std::size_t& common)
+{
+    // Both trees are read in full before any node is released or relinked
+    std::vector<BinNodePointer> nodesA, nodesB, kept;
+    for (BinNodePointer x = a == nullptr ? nullptr : BSTNodeOps::minimum(a); x != nullptr;
+         x = BSTNodeOps::successor(x))
+        nodesA.push_back(x);
+    for (BinNodePointer y = b == nullptr ? nullptr : BSTNodeOps::minimum(b); y != nullptr;
+         y = BSTNodeOps::successor(y))
+        nodesB.push_back(y);
+    kept.reserve(nodesA.size() + nodesB.size());
+
+    auto keepOrRelease = [&](BinNodePointer nodePtr, bool keep)
+    {
+        if (keep)
+            kept.push_back(nodePtr);
+        else
+            destroyNode(nodePtr);
+    };
+    std::size_t i = 0,
+                j = 0;
+    while (i < nodesA.size() || j < nodesB.size())
+    {
+        if (j == nodesB.size())
+            keepOrRelease(nodesA[i++], keepOnlyA);
+        else if (i == nodesA.size())
+            keepOrRelease(nodesB[j++], keepOnlyB);
+        else
+        {
+            auto order = compareKeys(nodesA[i]->data, nodesB[j]->data);
+            if (order < 0)
+                keepOrRelease(nodesA[i++], keepOnlyA);
+            else if (order > 0)
+                keepOrRelease(nodesB[j++], keepOnlyB);
+            else
+            {
+                keepOrRelease(nodesA[i++], keepBoth);
+                destroyNode(nodesB[j++]);
+                ++common;
+            }
+        }
+    }
+
+    int maxDepth = 0;                 // depth of the deepest level
+    for (std::size_t levelEnd = 1; levelEnd < kept.size(); levelEnd = 2 * levelEnd + 1)
+        ++maxDepth;
+    return linkBuiltAux(kept.data(), kept.size(), 0, maxDepth);
+}
+
+//--- Definition of adoptTree()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::adoptTree(BST& other)
 {
-    // Add code here
-    // This should work exactly the same as search, 
-    // but the locptr, found, and parent pointers will 
-    // be passed by reference
-    // and therefore returned to the calling function. 
-    // see (remove)
+    BinNodePointer root;
+    if (myAlloc == other.myAlloc)
+    {
+        root = other.myRoot;
+        other.myRoot = nullptr;
+        other.mySize = 0;
+        other.myAlloc = NodeAllocTraits::select_on_container_copy_construction(other.myAlloc);
+    }
+    else
+    {
+        root = cloneTree(other.myRoot);
+        other.clear();
+    }
+    return root;
 }
 
-template <class DataType>
-void BST<DataType>::inorderAux(std::ostream &out,
-                               BST<DataType>::BinNodePointer subtreeRoot,
-                               std::string separator)
+//--- Definition of asTree()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::asTree(BinNodePointer subtreeRoot)
 {
     if (subtreeRoot != nullptr)
     {
-        inorderAux(out, subtreeRoot->left, separator);    // L operation
-        out << subtreeRoot->data << separator;      // V operation
-        inorderAux(out, subtreeRoot->right, separator);   // R operation
+        subtreeRoot->parent = nullptr;
+        Balance::initRoot(subtreeRoot);
+    }
+    return subtreeRoot;
+}
+
+//--- Definition of search2()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::search2(const DataType& item, bool& found,
+    BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer& locptr,
+    BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer& parent)
+{
+    locptr = myRoot;
+    parent = nullptr;
+    found = false;
+    while (!found && locptr != nullptr)
+    {
+        auto order = compareKeys(item, locptr->data);
+        if (order < 0)                 // descend left
+        {
+            parent = locptr;
+            locptr = locptr->left;
+        }
+        else if (order > 0)            // descend right
+        {
+            parent = locptr;
+            locptr = locptr->right;
+        }
+        else                           // item found
+            found = true;
+    }
+}
+
+//--- Definition of inorderAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::inorderAux(BinNodePointer subtreeRoot, Visitor& visit) const
+{
+    if (subtreeRoot == nullptr)
+        return true;
+    BinNodePointer node = BSTNodeOps::minimum(subtreeRoot);
+    for (;;)
+    {
+        if (!visitItem(visit, node->data))        // V operation
+            return false;
+        if (node->right != nullptr)               // R operation
+            node = BSTNodeOps::minimum(node->right);
+        else
+        {
+            // Climb out of finished right subtrees; the first ancestor
+            // reached from its left is next.
+            while (node != subtreeRoot && node == node->parent->right)
+                node = node->parent;
+            if (node == subtreeRoot)
+                return true;
+            node = node->parent;
+        }
+    }
+}
+
+//--- Definition of preorderAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::preorderAux(BinNodePointer subtreeRoot, Visitor& visit) const
+{
+    if (subtreeRoot == nullptr)
+        return true;
+    BinNodePointer node = subtreeRoot;
+    for (;;)
+    {
+        if (!visitItem(visit, node->data))        // V operation
+            return false;
+        if (node->left != nullptr)                // L operation
+            node = node->left;
+        else if (node->right != nullptr)          // R operation
+            node = node->right;
+        else
+        {
+            // Climb to the nearest ancestor whose right subtree is unvisited
+            while (node != subtreeRoot &&
+                   (node == node->parent->right || node->parent->right == nullptr))
+                node = node->parent;
+            if (node == subtreeRoot)
+                return true;
+            node = node->parent->right;
+        }
+    }
+}
+
+//--- Definition of postorderAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::postorderAux(BinNodePointer subtreeRoot, Visitor& visit) const
+{
+    if (subtreeRoot == nullptr)
+        return true;
+    BinNodePointer node = firstPostorder(subtreeRoot);
+    for (;;)
+    {
+        if (!visitItem(visit, node->data))        // V operation
+            return false;
+        if (node == subtreeRoot)
+            return true;
+        // A left child is followed by its sibling subtree, if any;
+        // otherwise the parent is finished next.
+        BinNodePointer parent = node->parent;
+        if (node == parent->left && parent->right != nullptr)
+            node = firstPostorder(parent->right);
+        else
+            node = parent;
     }
 }
 
-template <class DataType>
-void BST<DataType>::preorderAux(std::ostream &out,
-                                BST<DataType>::BinNodePointer subtreeRoot,
-                                std::string separator)
+//--- Definition of subtreeSize()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline std::size_t BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::subtreeSize(BinNodePointer subtreeRoot)
 {
-    // add code here
+    return subtreeRoot == nullptr ? 0 : subtreeRoot->size;
 }
 
-template <class DataType>
-void BST<DataType>::postorderAux(std::ostream &out,
-                                 BST<DataType>::BinNodePointer subtreeRoot,
-                                 std::string separator)
+//--- Definition of subtreeAggregate()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename Augment::value_type
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::subtreeAggregate(BinNodePointer subtreeRoot)
 {
-    // add code here
+    return subtreeRoot == nullptr ? Augment::identity() : subtreeRoot->aggregate;
 }
 
+//--- Definition of firstPostorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+typename BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer
+BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::firstPostorder(BinNodePointer subtreeRoot)
+{
+    for (;;)
+    {
+        if (subtreeRoot->left != nullptr)
+            subtreeRoot = subtreeRoot->left;
+        else if (subtreeRoot->right != nullptr)
+            subtreeRoot = subtreeRoot->right;
+        else
+            return subtreeRoot;
+    }
+}
 
+//--- Definition of visitItem()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+inline bool BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::visitItem(Visitor& visit, const DataType& item)
+{
+    if constexpr (std::is_same_v<std::invoke_result_t<Visitor&, const DataType&>, bool>)
+        return visit(item);
+    else
+    {
+        visit(item);
+        return true;
+    }
+}
 
 //--- Definition of graphAux()
 #include <iomanip>
 
-template <class DataType>
-void BST<DataType>::graphAux(std::ostream &out, int indent,
-                             BST<DataType>::BinNodePointer subtreeRoot)
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::graphAux(std::ostream &out, int indent,
+                             BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::BinNodePointer subtreeRoot)
 {
     if (subtreeRoot != nullptr)
     {
         graphAux(out, indent + 8, subtreeRoot->right);
-        out << std::setw(indent) << " " << subtreeRoot->data << std::endl;
+        out << std::setw(indent) << " " << subtreeRoot->data << '\n';
         graphAux(out, indent + 8, subtreeRoot->left);
     }
     else
-        out << std::setw(indent) << " " << "_" << std::endl;
+        out << std::setw(indent) << " " << "_" << '\n';
 }
 
+//--- Definition of writeGraphAux()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::writeGraphAux(BufferedWriter& out, std::size_t indent,
+                                                           BinNodePointer subtreeRoot) const
+{
+    // setw(indent) << " " in graphAux pads to indent columns, at least one
+    std::size_t padding = std::max<std::size_t>(indent, 1);
+    if (subtreeRoot != nullptr)
+    {
+        writeGraphAux(out, indent + 8, subtreeRoot->right);
+        out.fill(' ', padding);
+        out.write(subtreeRoot->data);
+        out.write('\n');
+        writeGraphAux(out, indent + 8, subtreeRoot->left);
+    }
+    else
+    {
+        out.fill(' ', padding);
+        out.write("_\n");
+    }
+}
 
+#endif  // BST_H_
@@ -0,0 +1,147 @@
+/**
+ * @file BSTAugment.h
+ * @brief Augmentation policies for class template BST.
+ *
+ * An augmentation policy is passed as the Augment template parameter of BST.
+ * Every node then stores the aggregate of the items in its subtree, kept up
+ * to date on the insert and remove paths and by the rotations of the
+ * balancing policy, and BST::aggregate answers range queries in O(log n).
+ *
+ * A policy is a monoid over value_type and provides:
+ * - value_type: Type of the aggregates
+ * - identity: Neutral element of combine
+ * - lift: Aggregate of a single item
+ * - combine: Associative operation joining the aggregates of two adjacent
+ *   runs of items, the earlier run first (it need not be commutative)
+ *
+ * Available policies:
+ * - NoAugment: No aggregates (the default; adds nothing to the nodes)
+ * - SumAugment: Sum of the items
+ * - MinAugment, MaxAugment: Smallest and largest item
+ *
+ * The examples take an optional projection applied to each item, e.g. an
+ * interval tree ordered by low endpoint can use
+ * MaxAugment<int, HighEndpoint>, where HighEndpoint is a function object
+ * returning the high endpoint of an interval.
+ */
+
+#ifndef BSTAUGMENT_H_
+#define BSTAUGMENT_H_
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+/**
+ * @struct NoAugment
+ * @brief Augmentation policy that stores no aggregates.
+ */
+struct NoAugment
+{
+    typedef void value_type;    // there is nothing to aggregate
+};
+
+/**
+ * @class SubtreeAggregate
+ * @brief Aggregate of a subtree, stored in the nodes of augmented BSTs;
+ *        empty (and free, as a base class) for NoAugment.
+ */
+template <typename Augment>
+class SubtreeAggregate
+{
+public:
+    typename Augment::value_type aggregate = Augment::identity();
+};
+
+template <>
+class SubtreeAggregate<NoAugment>
+{};
+
+/**
+ * @struct SumAugment
+ * @brief Sum of the (projected) items.
+ *
+ * @tparam Value Type of the sums.
+ * @tparam Projection Function object mapping an item to a Value (optional).
+ */
+template <typename Value, typename Projection = std::identity>
+struct SumAugment
+{
+    typedef Value value_type;
+
+    static value_type identity()
+    {
+        return value_type();
+    }
+
+    template <typename Item>
+    static value_type lift(const Item& item)
+    {
+        return static_cast<value_type>(std::invoke(Projection(), item));
+    }
+
+    static value_type combine(const value_type& a, const value_type& b)
+    {
+        return a + b;
+    }
+};
+
+/**
+ * @struct MinAugment
+ * @brief Smallest (projected) item; the identity is the largest Value.
+ *
+ * @tparam Value Type of the aggregates, with std::numeric_limits.
+ * @tparam Projection Function object mapping an item to a Value (optional).
+ */
+template <typename Value, typename Projection = std::identity>
+struct MinAugment
+{
+    typedef Value value_type;
+
+    static value_type identity()
+    {
+        return std::numeric_limits<value_type>::max();
+    }
+
+    template <typename Item>
+    static value_type lift(const Item& item)
+    {
+        return static_cast<value_type>(std::invoke(Projection(), item));
+    }
+
+    static value_type combine(const value_type& a, const value_type& b)
+    {
+        return std::min(a, b);
+    }
+};
+
+/**
+ * @struct MaxAugment
+ * @brief Largest (projected) item; the identity is the lowest Value.
+ *
+ * @tparam Value Type of the aggregates, with std::numeric_limits.
+ * @tparam Projection Function object mapping an item to a Value (optional).
+ */
+template <typename Value, typename Projection = std::identity>
+struct MaxAugment
+{
+    typedef Value value_type;
+
+    static value_type identity()
+    {
+        return std::numeric_limits<value_type>::lowest();
+    }
+
+    template <typename Item>
+    static value_type lift(const Item& item)
+    {
+        return static_cast<value_type>(std::invoke(Projection(), item));
+    }
+
+    static value_type combine(const value_type& a, const value_type& b)
+    {
+        return std::max(a, b);
+    }
+};
+
+#endif  // BSTAUGMENT_H_
@@ -0,0 +1,743 @@
+/**
+ * @file BSTBalance.h
+ * @brief Balancing policies for class template BST.
+ *
+ * A balancing policy is passed as the Balance template parameter of BST and
+ * provides:
+ * - NodeData: per-node bookkeeping mixed into every tree node
+ * - insertFixup: Restores balance after a node has been linked in
+ * - erase: Unlinks a node from the tree and restores balance
+ * - initBuilt: Sets the bookkeeping of a node in a tree built bottom-up
+ *   with minimal height (all levels full except possibly the deepest)
+ * - join: Links two trees and a middle node into one balanced tree, in
+ *   time proportional to the difference of their heights
+ * - initRoot: Lets the root of a former subtree serve as the root of a tree
+ *
+ * Available policies:
+ * - Unbalanced: Plain binary search tree (no rebalancing)
+ * - RedBlack: Red-black tree
+ * - AVL: Height-balanced AVL tree
+ *
+ * Structural helpers shared by the policies live in BSTNodeOps.  Nodes are
+ * expected to expose left, right and parent links, a static constexpr bool
+ * augmented, and an update() member that recomputes data derived from the
+ * node's children.  When augmented is true, BSTNodeOps calls update() on
+ * every node whose subtree it changes, bottom-up.
+ */
+
+#ifndef BSTBALANCE_H_
+#define BSTBALANCE_H_
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+/**
+ * @class BSTNodeOps
+ * @brief Link-level operations on parent-linked binary tree nodes.
+ */
+class BSTNodeOps
+{
+public:
+    /**
+     * @brief Returns the leftmost node of the subtree rooted at x.
+     */
+    template <typename Node>
+    static Node* minimum(Node* x)
+    {
+        while (x->left != nullptr)
+            x = x->left;
+        return x;
+    }
+
+    /**
+     * @brief Returns the rightmost node of the subtree rooted at x.
+     */
+    template <typename Node>
+    static Node* maximum(Node* x)
+    {
+        while (x->right != nullptr)
+            x = x->right;
+        return x;
+    }
+
+    /**
+     * @brief Returns the inorder successor of x, or null if x is the last node.
+     */
+    template <typename Node>
+    static Node* successor(Node* x)
+    {
+        if (x->right != nullptr)
+            return minimum(x->right);
+        Node* parent = x->parent;
+        while (parent != nullptr && x == parent->right)
+        {
+            x = parent;
+            parent = parent->parent;
+        }
+        return parent;
+    }
+
+    /**
+     * @brief Returns the inorder predecessor of x, or null if x is the first node.
+     */
+    template <typename Node>
+    static Node* predecessor(Node* x)
+    {
+        if (x->left != nullptr)
+            return maximum(x->left);
+        Node* parent = x->parent;
+        while (parent != nullptr && x == parent->left)
+        {
+            x = parent;
+            parent = parent->parent;
+        }
+        return parent;
+    }
+
+    /**
+     * @brief Replaces the subtree rooted at u by the subtree rooted at v.
+     *
+     * @param root Root of the tree containing u.
+     * @param u Node being replaced.
+     * @param v Replacement subtree (may be null).
+     */
+    template <typename Node>
+    static void transplant(Node*& root, Node* u, Node* v)
+    {
+        if (u->parent == nullptr)
+            root = v;
+        else if (u == u->parent->left)
+            u->parent->left = v;
+        else
+            u->parent->right = v;
+        if (v != nullptr)
+            v->parent = u->parent;
+    }
+
+    /**
+     * @brief Rotates x down to the left; its right child takes its place.
+     */
+    template <typename Node>
+    static void rotateLeft(Node*& root, Node* x)
+    {
+        Node* y = x->right;
+        x->right = y->left;
+        if (y->left != nullptr)
+            y->left->parent = x;
+        transplant(root, x, y);
+        y->left = x;
+        x->parent = y;
+        if constexpr (Node::augmented)
+        {
+            x->update();
+            y->update();
+        }
+    }
+
+    /**
+     * @brief Rotates x down to the right; its left child takes its place.
+     */
+    template <typename Node>
+    static void rotateRight(Node*& root, Node* x)
+    {
+        Node* y = x->left;
+        x->left = y->right;
+        if (y->right != nullptr)
+            y->right->parent = x;
+        transplant(root, x, y);
+        y->right = x;
+        x->parent = y;
+        if constexpr (Node::augmented)
+        {
+            x->update();
+            y->update();
+        }
+    }
+
+    /**
+     * @brief Links a detached node below parent.
+     *
+     * @param root Root of the tree.
+     * @param parent New parent of node (null if the tree is empty).
+     * @param node Node being linked in.
+     * @param asLeft true to become the left child of parent, false for the right.
+     */
+    template <typename Node>
+    static void attach(Node*& root, Node* parent, Node* node, bool asLeft)
+    {
+        node->parent = parent;
+        if (parent == nullptr)
+            root = node;
+        else if (asLeft)
+            parent->left = node;
+        else
+            parent->right = node;
+        updatePath(node);
+    }
+
+    /**
+     * @brief Unlinks z from the tree without releasing it.
+     *
+     * A node with two children is replaced by its inorder successor, which is
+     * relinked (not copied) into z's position.
+     *
+     * @param root Root of the tree containing z.
+     * @param z Node being removed.
+     * @param x Set to the subtree that moved up into the vacated position (may be null).
+     * @param xParent Set to the parent of that position.
+     */
+    template <typename Node>
+    static void unlink(Node*& root, Node* z, Node*& x, Node*& xParent)
+    {
+        if (z->left == nullptr)
+        {
+            x = z->right;
+            xParent = z->parent;
+            transplant(root, z, z->right);
+        }
+        else if (z->right == nullptr)
+        {
+            x = z->left;
+            xParent = z->parent;
+            transplant(root, z, z->left);
+        }
+        else
+        {                                // node has 2 children
+            Node* y = minimum(z->right);
+            x = y->right;
+            if (y->parent == z)
+                xParent = y;
+            else
+            {
+                xParent = y->parent;
+                transplant(root, y, y->right);
+                y->right = z->right;
+                y->right->parent = y;
+            }
+            transplant(root, z, y);
+            y->left = z->left;
+            y->left->parent = y;
+        }
+        updatePath(xParent);        // passes through y, if it moved
+    }
+
+    /**
+     * @brief Makes left and right the subtrees of mid and refreshes the
+     *        augmented data of mid and its ancestors.
+     */
+    template <typename Node>
+    static void link(Node* left, Node* mid, Node* right)
+    {
+        mid->left = left;
+        if (left != nullptr)
+            left->parent = mid;
+        mid->right = right;
+        if (right != nullptr)
+            right->parent = mid;
+        updatePath(mid);
+    }
+
+    /**
+     * @brief Calls update() on x and each of its ancestors, if Node is
+     *        augmented.
+     */
+    template <typename Node>
+    static void updatePath(Node* x)
+    {
+        if constexpr (Node::augmented)
+        {
+            for (; x != nullptr; x = x->parent)
+                x->update();
+        }
+    }
+};
+
+/**
+ * @struct Unbalanced
+ * @brief Balancing policy that leaves the tree shape to the input order.
+ */
+struct Unbalanced
+{
+    class NodeData
+    {};
+
+    template <typename Node>
+    static void insertFixup(Node*& /*root*/, Node* /*x*/)
+    {}
+
+    template <typename Node>
+    static void erase(Node*& root, Node* z)
+    {
+        Node* x;
+        Node* xParent;
+        BSTNodeOps::unlink(root, z, x, xParent);
+    }
+
+    template <typename Node>
+    static void initBuilt(Node* /*x*/, int /*depth*/, int /*maxDepth*/)
+    {}
+
+    template <typename Node>
+    static void initRoot(Node* /*x*/)
+    {}
+
+    /**
+     * @brief Returns mid with left and right as its subtrees.
+     *
+     * @param left Tree whose items all precede mid's (may be null).
+     * @param mid Detached node; its links are overwritten.
+     * @param right Tree whose items all follow mid's (may be null).
+     * @return Root of the joined tree.
+     */
+    template <typename Node>
+    static Node* join(Node* left, Node* mid, Node* right)
+    {
+        mid->parent = nullptr;
+        BSTNodeOps::link(left, mid, right);
+        return mid;
+    }
+};
+
+/**
+ * @struct RedBlack
+ * @brief Red-black balancing policy.
+ *
+ * Keeps the number of black nodes equal on every root-to-leaf path and
+ * forbids red nodes with red children, bounding the height by 2 log2(n + 1).
+ */
+struct RedBlack
+{
+    class NodeData
+    {
+    public:
+        bool red = true;   // new nodes are linked in red
+    };
+
+    /**
+     * @brief Repairs red-red violations above the freshly linked red node x.
+     */
+    template <typename Node>
+    static void insertFixup(Node*& root, Node* x)
+    {
+        while (x->parent != nullptr && x->parent->red)
+        {
+            Node* parent = x->parent;
+            Node* grand = parent->parent;   // exists since the root is black
+            if (parent == grand->left)
+            {
+                Node* uncle = grand->right;
+                if (isRed(uncle))
+                {
+                    parent->red = false;
+                    uncle->red = false;
+                    grand->red = true;
+                    x = grand;
+                }
+                else
+                {
+                    if (x == parent->right)
+                    {
+                        x = parent;
+                        BSTNodeOps::rotateLeft(root, x);
+                        parent = x->parent;
+                    }
+                    parent->red = false;
+                    grand->red = true;
+                    BSTNodeOps::rotateRight(root, grand);
+                }
+            }
+            else
+            {
+                Node* uncle = grand->left;
+                if (isRed(uncle))
+                {
+                    parent->red = false;
+                    uncle->red = false;
+                    grand->red = true;
+                    x = grand;
+                }
+                else
+                {
+                    if (x == parent->left)
+                    {
+                        x = parent;
+                        BSTNodeOps::rotateRight(root, x);
+                        parent = x->parent;
+                    }
+                    parent->red = false;
+                    grand->red = true;
+                    BSTNodeOps::rotateLeft(root, grand);
+                }
+            }
+        }
+        root->red = false;
+    }
+
+    /**
+     * @brief Unlinks z and repairs the black height of the affected path.
+     */
+    template <typename Node>
+    static void erase(Node*& root, Node* z)
+    {
+        // The successor moving into z's position takes over z's color, so
+        // the color actually leaving the tree is the successor's.
+        if (z->left != nullptr && z->right != nullptr)
+            std::swap(z->red, BSTNodeOps::minimum(z->right)->red);
+        bool removedRed = z->red;
+        Node* x;
+        Node* xParent;
+        BSTNodeOps::unlink(root, z, x, xParent);
+        if (!removedRed)
+            eraseFixup(root, x, xParent);
+    }
+
+    /**
+     * @brief Colors a node of a minimal-height tree built bottom-up.
+     *
+     * Every path holds one black node per full level, so only the nodes on
+     * a partially filled deepest level are red.
+     */
+    template <typename Node>
+    static void initBuilt(Node* x, int depth, int maxDepth)
+    {
+        x->red = depth == maxDepth && depth > 0;
+    }
+
+    /**
+     * @brief Blackens the root of a former subtree, which keeps every path
+     *        balanced.
+     */
+    template <typename Node>
+    static void initRoot(Node* x)
+    {
+        x->red = false;
+    }
+
+    /**
+     * @brief Joins left, mid and right into one red-black tree.
+     *
+     * The tree with the larger black height absorbs the other: mid is
+     * linked in red at the black node of equal black height on its inner
+     * spine, then red-red violations are repaired as after an insert.
+     *
+     * @param left Red-black tree whose items all precede mid's (may be null;
+     *             the root may be red, e.g. a former subtree).
+     * @param mid Detached node; its links and color are overwritten.
+     * @param right Red-black tree whose items all follow mid's (may be null).
+     * @return Root of the joined tree.
+     */
+    template <typename Node>
+    static Node* join(Node* left, Node* mid, Node* right)
+    {
+        if (left != nullptr)
+        {
+            left->parent = nullptr;
+            left->red = false;
+        }
+        if (right != nullptr)
+        {
+            right->parent = nullptr;
+            right->red = false;
+        }
+        int leftHeight = blackHeight(left),
+            rightHeight = blackHeight(right);
+        mid->parent = nullptr;
+        if (leftHeight == rightHeight)
+        {
+            mid->red = false;
+            BSTNodeOps::link(left, mid, right);
+            return mid;
+        }
+
+        bool intoLeft = leftHeight > rightHeight;
+        Node* root = intoLeft ? left : right;
+        int height = intoLeft ? leftHeight : rightHeight,
+            target = intoLeft ? rightHeight : leftHeight;
+        Node* parent = nullptr;
+        Node* x = root;               // walks the inner spine of the taller tree
+        while (isRed(x) || height != target)
+        {
+            if (!isRed(x))
+                --height;
+            parent = x;
+            x = intoLeft ? x->right : x->left;
+        }
+        mid->red = true;
+        mid->parent = parent;
+        if (intoLeft)
+        {
+            parent->right = mid;
+            BSTNodeOps::link(x, mid, right);
+        }
+        else
+        {
+            parent->left = mid;
+            BSTNodeOps::link(left, mid, x);
+        }
+        insertFixup(root, mid);
+        return root;
+    }
+
+private:
+    /**
+     * Counts the black nodes on the left spine of the subtree rooted at x.
+     */
+    template <typename Node>
+    static int blackHeight(const Node* x)
+    {
+        int height = 0;
+        for (; x != nullptr; x = x->left)
+            height += !x->red;
+        return height;
+    }
+
+    template <typename Node>
+    static bool isRed(const Node* x)
+    {
+        return x != nullptr && x->red;
+    }
+
+    /**
+     * Pushes the missing black from x (which may be null) up the tree until
+     * it can be absorbed.
+     */
+    template <typename Node>
+    static void eraseFixup(Node*& root, Node* x, Node* xParent)
+    {
+        while (x != root && !isRed(x))
+        {
+            if (x == xParent->left)
+            {
+                Node* sibling = xParent->right;
+                if (sibling->red)
+                {
+                    sibling->red = false;
+                    xParent->red = true;
+                    BSTNodeOps::rotateLeft(root, xParent);
+                    sibling = xParent->right;
+                }
+                if (!isRed(sibling->left) && !isRed(sibling->right))
+                {
+                    sibling->red = true;
+                    x = xParent;
+                    xParent = x->parent;
+                }
+                else
+                {
+                    if (!isRed(sibling->right))
+                    {
+                        sibling->left->red = false;
+                        sibling->red = true;
+                        BSTNodeOps::rotateRight(root, sibling);
+                        sibling = xParent->right;
+                    }
+                    sibling->red = xParent->red;
+                    xParent->red = false;
+                    sibling->right->red = false;
+                    BSTNodeOps::rotateLeft(root, xParent);
+                    x = root;
+                }
+            }
+            else
+            {
+                Node* sibling = xParent->left;
+                if (sibling->red)
+                {
+                    sibling->red = false;
+                    xParent->red = true;
+                    BSTNodeOps::rotateRight(root, xParent);
+                    sibling = xParent->left;
+                }
+                if (!isRed(sibling->left) && !isRed(sibling->right))
+                {
+                    sibling->red = true;
+                    x = xParent;
+                    xParent = x->parent;
+                }
+                else
+                {
+                    if (!isRed(sibling->left))
+                    {
+                        sibling->right->red = false;
+                        sibling->red = true;
+                        BSTNodeOps::rotateLeft(root, sibling);
+                        sibling = xParent->left;
+                    }
+                    sibling->red = xParent->red;
+                    xParent->red = false;
+                    sibling->left->red = false;
+                    BSTNodeOps::rotateRight(root, xParent);
+                    x = root;
+                }
+            }
+        }
+        if (x != nullptr)
+            x->red = false;
+    }
+};
+
+/**
+ * @struct AVL
+ * @brief AVL balancing policy.
+ *
+ * Keeps the heights of the two subtrees of every node within one of each
+ * other, bounding the height by about 1.44 log2(n + 2).
+ */
+struct AVL
+{
+    class NodeData
+    {
+    public:
+        int height = 1;    // height of the subtree rooted at this node
+    };
+
+    /**
+     * @brief Rebalances the ancestors of the freshly linked leaf x.
+     */
+    template <typename Node>
+    static void insertFixup(Node*& root, Node* x)
+    {
+        retrace(root, x->parent);
+    }
+
+    /**
+     * @brief Unlinks z and rebalances the ancestors of the vacated position.
+     */
+    template <typename Node>
+    static void erase(Node*& root, Node* z)
+    {
+        Node* x;
+        Node* xParent;
+        BSTNodeOps::unlink(root, z, x, xParent);
+        retrace(root, xParent);
+    }
+
+    /**
+     * @brief Sets the height of a node whose children are already built.
+     */
+    template <typename Node>
+    static void initBuilt(Node* x, int /*depth*/, int /*maxDepth*/)
+    {
+        fixHeight(x);
+    }
+
+    template <typename Node>
+    static void initRoot(Node* /*x*/)
+    {}
+
+    /**
+     * @brief Joins left, mid and right into one AVL tree.
+     *
+     * If the heights differ by more than one, mid is linked in at the node
+     * of about the shorter tree's height on the inner spine of the taller
+     * one, whose ancestors are then retraced as after an insert.
+     *
+     * @param left AVL tree whose items all precede mid's (may be null).
+     * @param mid Detached node; its links and height are overwritten.
+     * @param right AVL tree whose items all follow mid's (may be null).
+     * @return Root of the joined tree.
+     */
+    template <typename Node>
+    static Node* join(Node* left, Node* mid, Node* right)
+    {
+        if (left != nullptr)
+            left->parent = nullptr;
+        if (right != nullptr)
+            right->parent = nullptr;
+        int leftHeight = height(left),
+            rightHeight = height(right);
+        mid->parent = nullptr;
+        if (std::abs(leftHeight - rightHeight) <= 1)
+        {
+            BSTNodeOps::link(left, mid, right);
+            fixHeight(mid);
+            return mid;
+        }
+
+        bool intoLeft = leftHeight > rightHeight;
+        Node* root = intoLeft ? left : right;
+        int target = (intoLeft ? rightHeight : leftHeight) + 1;
+        Node* parent = nullptr;
+        Node* x = root;               // walks the inner spine of the taller tree
+        while (height(x) > target)
+        {
+            parent = x;
+            x = intoLeft ? x->right : x->left;
+        }
+        mid->parent = parent;
+        if (intoLeft)
+        {
+            parent->right = mid;
+            BSTNodeOps::link(x, mid, right);
+        }
+        else
+        {
+            parent->left = mid;
+            BSTNodeOps::link(left, mid, x);
+        }
+        fixHeight(mid);
+        retrace(root, parent);
+        return root;
+    }
+
+private:
+    template <typename Node>
+    static int height(const Node* x)
+    {
+        return x == nullptr ? 0 : x->height;
+    }
+
+    template <typename Node>
+    static void fixHeight(Node* x)
+    {
+        x->height = 1 + std::max(height(x->left), height(x->right));
+    }
+
+    template <typename Node>
+    static void rotateLeft(Node*& root, Node* x)
+    {
+        BSTNodeOps::rotateLeft(root, x);
+        fixHeight(x);
+        fixHeight(x->parent);
+    }
+
+    template <typename Node>
+    static void rotateRight(Node*& root, Node* x)
+    {
+        BSTNodeOps::rotateRight(root, x);
+        fixHeight(x);
+        fixHeight(x->parent);
+    }
+
+    /**
+     * Walks from x to the root, refreshing heights and rotating wherever the
+     * balance factor has left [-1, 1].
+     */
+    template <typename Node>
+    static void retrace(Node*& root, Node* x)
+    {
+        while (x != nullptr)
+        {
+            fixHeight(x);
+            int balance = height(x->left) - height(x->right);
+            if (balance > 1)
+            {
+                if (height(x->left->left) < height(x->left->right))
+                    rotateLeft(root, x->left);
+                rotateRight(root, x);
+                x = x->parent;            // new root of this subtree
+            }
+            else if (balance < -1)
+            {
+                if (height(x->right->right) < height(x->right->left))
+                    rotateRight(root, x->right);
+                rotateLeft(root, x);
+                x = x->parent;
+            }
+            x = x->parent;
+        }
+    }
+};
+
+#endif  // BSTBALANCE_H_
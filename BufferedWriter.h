@@ -0,0 +1,172 @@
+/**
+ * @file BufferedWriter.h
+ * @brief Declaration of class BufferedWriter.
+ *
+ * This file contains a small output buffer for bulk text dumps such as
+ * BST::write_inorder.  Values are formatted straight into one reusable
+ * buffer (numbers with std::to_chars), and the buffer reaches the
+ * underlying stream only when it fills up or when the writer is flushed
+ * or destroyed.
+ *
+ * Basic operations include:
+ * - write: Append a value, a character or a piece of text
+ * - fill: Append a character repeated a number of times
+ * - flush: Hand the buffered text to the stream and flush it
+ *
+ * Arithmetic values are formatted like the "C" locale with default stream
+ * flags, regardless of the locale and flags of the stream.
+ */
+
+#ifndef BUFFEREDWRITER_H_
+#define BUFFEREDWRITER_H_
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class BufferedWriter
+ * @brief Formats values into a large buffer in front of an output stream.
+ *
+ * Types that are neither arithmetic nor convertible to std::string_view are
+ * formatted with their operator<< through a reused string stream.
+ */
+class BufferedWriter
+{
+public:
+    /**
+     * @brief Constructs a writer in front of out.
+     *
+     * @param out Stream that receives the text.
+     * @param capacity Size of the buffer in bytes (optional).
+     */
+    explicit BufferedWriter(std::ostream& out, std::size_t capacity = 64 * 1024)
+        : myOut(out), myBuffer(std::max<std::size_t>(capacity, maxNumberLength)), mySize(0)
+    {}
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    /**
+     * @brief Flushes whatever is still buffered.
+     */
+    ~BufferedWriter()
+    {
+        flush();
+    }
+
+    /**
+     * @brief Appends a piece of text.
+     */
+    void write(std::string_view text)
+    {
+        if (text.size() > myBuffer.size() - mySize)
+        {
+            drain();
+            if (text.size() > myBuffer.size())
+            {                           // too large to be worth copying
+                myOut.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return;
+            }
+        }
+        std::copy(text.begin(), text.end(), myBuffer.data() + mySize);
+        mySize += text.size();
+    }
+
+    /**
+     * @brief Appends one character.
+     */
+    void write(char c)
+    {
+        if (mySize == myBuffer.size())
+            drain();
+        myBuffer[mySize++] = c;
+    }
+
+    /**
+     * @brief Appends a value.
+     *
+     * @param value Number, text, or any type with an operator<<.
+     */
+    template <typename T>
+    void write(const T& value)
+    {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>)
+            write(std::string_view(value));
+        else if constexpr (std::is_same_v<T, bool>)
+            write(value ? '1' : '0');
+        else if constexpr (std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>)
+            write(static_cast<char>(value));
+        else if constexpr (std::is_arithmetic_v<T>)
+        {
+            if (myBuffer.size() - mySize < maxNumberLength)
+                drain();
+            char* first = myBuffer.data() + mySize;
+            char* last = myBuffer.data() + myBuffer.size();
+            std::to_chars_result result;
+            if constexpr (std::is_floating_point_v<T>)
+                result = std::to_chars(first, last, value, std::chars_format::general, 6);  // as %g
+            else
+                result = std::to_chars(first, last, value);
+            mySize += static_cast<std::size_t>(result.ptr - first);
+        }
+        else
+        {
+            myFallback.str(std::string());
+            myFallback << value;
+            write(myFallback.view());
+        }
+    }
+
+    /**
+     * @brief Appends count copies of the character c.
+     */
+    void fill(char c, std::size_t count)
+    {
+        while (count > 0)
+        {
+            if (mySize == myBuffer.size())
+                drain();
+            std::size_t n = std::min(count, myBuffer.size() - mySize);
+            std::fill_n(myBuffer.data() + mySize, n, c);
+            mySize += n;
+            count -= n;
+        }
+    }
+
+    /**
+     * @brief Hands the buffered text to the stream and flushes the stream.
+     */
+    void flush()
+    {
+        drain();
+        myOut.flush();
+    }
+
+private:
+    /***** Longest text std::to_chars produces for a built-in type *****/
+    static constexpr std::size_t maxNumberLength = 128;
+
+    /**
+     * Hands the buffered text to the stream without flushing it.
+     */
+    void drain()
+    {
+        myOut.write(myBuffer.data(), static_cast<std::streamsize>(mySize));
+        mySize = 0;
+    }
+
+    /***** Data Members *****/
+    std::ostream& myOut;
+    std::vector<char> myBuffer;
+    std::size_t mySize;                 // bytes in use at the front of myBuffer
+    std::ostringstream myFallback;      // formats types without to_chars
+};
+
+#endif  // BUFFEREDWRITER_H_
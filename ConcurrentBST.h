@@ -0,0 +1,356 @@
+/**
+ * @file ConcurrentBST.h
+ * @brief Declaration of class template ConcurrentBST.
+ *
+ * This file contains a thread-safe wrapper around BST guarded by a
+ * reader-writer lock.  Lookups and traversals take the lock in shared mode,
+ * so any number of them run in parallel; insert, remove and clear take it
+ * exclusively.
+ *
+ * Basic operations include:
+ * - search, lower_bound, size, empty: Lookups under a shared lock
+ * - inorder, for_each_inorder, range: Traversals under a shared lock
+ * - insert, try_insert, remove, try_erase, clear: Updates under an
+ *   exclusive lock
+ * - read, write: Run a callable on the underlying BST under a shared or
+ *   exclusive lock
+ * - snapshot: Copy the current contents into a plain BST
+ *
+ * Results are returned by value, never as iterators or references into the
+ * tree, since those could dangle once the lock is released.  Visitors run
+ * while the lock is held and must not call back into the same
+ * ConcurrentBST.
+ */
+
+#ifndef CONCURRENTBST_H_
+#define CONCURRENTBST_H_
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+
+#include "BST.h"
+
+/**
+ * @class ConcurrentBST
+ * @brief A BST that may be shared by many reader and writer threads.
+ *
+ * The template parameters are those of BST.  The allocator is only used
+ * under the exclusive lock, so a PoolAllocator needs no locking of its own
+ * as long as its resource is not shared with other containers.
+ */
+template <typename DataType,
+          typename Alloc = PoolAllocator<DataType>,
+          typename Balance = Unbalanced,
+          typename Compare = std::less<>,
+          bool OrderStatistics = false,
+          typename Augment = NoAugment>
+class ConcurrentBST
+{
+public:
+    typedef BST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment> tree_type;
+
+    /**
+     * @brief Constructs an empty tree.
+     *
+     * @param alloc Allocator for the nodes (optional).
+     */
+    explicit ConcurrentBST(const Alloc& alloc = Alloc());
+
+    /**
+     * @brief Takes over the items of an existing tree.
+     *
+     * Moving the tree moves its allocator too, so tree itself keeps no
+     * handle on the nodes' pool.  If some other tree still shares the pool
+     * (e.g. the other half of a split), the items are copied into a pool of
+     * their own in O(n), since the lock could not guard the other tree's
+     * use of it.
+     *
+     * @param tree The tree to take over; left empty.
+     */
+    explicit ConcurrentBST(tree_type&& tree);
+
+    ConcurrentBST(const ConcurrentBST&) = delete;
+    ConcurrentBST& operator=(const ConcurrentBST&) = delete;
+
+    /**
+     * @brief Checks if the tree is empty.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Returns the number of items in the tree.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Searches for a given item.
+     *
+     * @param item The item to search for.
+     * @return true if the item is found, false otherwise.
+     */
+    bool search(const DataType& item) const;
+
+    /**
+     * @brief Finds the first item not less than the given item.
+     *
+     * @param item The item to compare against.
+     * @return A copy of the first item >= item, or nothing if there is none.
+     */
+    std::optional<DataType> lower_bound(const DataType& item) const;
+
+    /**
+     * @brief Outputs the items in order to the specified output stream.
+     *
+     * @param out The output stream to which the elements will be written.
+     * @param separator String to separate elements (optional).
+     */
+    void inorder(std::ostream& out, std::string_view separator = "  ") const;
+
+    /**
+     * @brief Calls visit on every item in order (see BST::for_each_inorder).
+     *
+     * @param visit Callable invoked as visit(item) under the shared lock.
+     * @return false if visit stopped the traversal early, true otherwise.
+     */
+    template <typename Visitor>
+    bool for_each_inorder(Visitor&& visit) const;
+
+    /**
+     * @brief Visits, in order, every item in [low, high) (see BST::range).
+     *
+     * @param low Smallest item to visit.
+     * @param high Items not less than high are not visited.
+     * @param visit Callable invoked as visit(item) under the shared lock.
+     * @return false if visit stopped early, true otherwise.
+     */
+    template <typename Visitor>
+    bool range(const DataType& low, const DataType& high, Visitor&& visit) const;
+
+    /**
+     * @brief Inserts an item into the tree.
+     *
+     * @param item The item to be inserted.
+     * @throws std::runtime_error if the item is already in the tree.
+     */
+    void insert(const DataType& item);
+
+    /**
+     * @brief Inserts an item if no equal item is present.
+     *
+     * @param item The item to be inserted.
+     * @return true if the item was inserted, false if it was already present.
+     */
+    bool try_insert(const DataType& item);
+
+    /**
+     * @brief Removes an item from the tree.
+     *
+     * @param item The item to be removed.
+     * @throws std::runtime_error if the item is not in the tree.
+     */
+    void remove(const DataType& item);
+
+    /**
+     * @brief Removes an item if present.
+     *
+     * @param item The item to be removed.
+     * @return true if the item was removed, false if it was not in the tree.
+     */
+    bool try_erase(const DataType& item);
+
+    /**
+     * @brief Removes all items from the tree.
+     */
+    void clear();
+
+    /**
+     * @brief Calls f(tree) with the underlying BST under a shared lock.
+     *
+     * Useful to run several lookups against one consistent state.  f must
+     * only use const members of the tree and must not let references or
+     * iterators into it escape.
+     *
+     * @return Whatever f returns.
+     */
+    template <typename F>
+    decltype(auto) read(F&& f) const;
+
+    /**
+     * @brief Calls f(tree) with the underlying BST under an exclusive lock.
+     *
+     * Useful to apply several updates atomically.
+     *
+     * @return Whatever f returns.
+     */
+    template <typename F>
+    decltype(auto) write(F&& f);
+
+    /**
+     * @brief Copies the current contents into a plain BST.
+     */
+    tree_type snapshot() const;
+
+private:
+    /***** Data Members *****/
+    mutable std::shared_mutex myMutex;
+    tree_type myTree;
+};
+
+//--- Definition of constructor
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::ConcurrentBST(const Alloc& alloc)
+    : myTree(alloc)
+{}
+
+//--- Definition of tree constructor
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::ConcurrentBST(tree_type&& tree)
+    : myTree(std::move(tree))
+{
+    if constexpr (requires(const typename tree_type::allocator_type& alloc) { alloc.resource().use_count(); })
+    {
+        auto alloc = myTree.get_allocator();
+        if (alloc.resource().use_count() > 2)    // more than myTree and alloc
+            myTree = tree_type(myTree);
+    }
+}
+
+//--- Definition of empty()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline bool ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::empty() const
+{
+    std::shared_lock<std::shared_mutex> lock(myMutex);
+    return myTree.empty();
+}
+
+//--- Definition of size()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline std::size_t ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(myMutex);
+    return myTree.size();
+}
+
+//--- Definition of search()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline bool ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::search(const DataType& item) const
+{
+    std::shared_lock<std::shared_mutex> lock(myMutex);
+    return myTree.search(item);
+}
+
+//--- Definition of lower_bound()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+std::optional<DataType>
+ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::lower_bound(const DataType& item) const
+{
+    std::shared_lock<std::shared_mutex> lock(myMutex);
+    auto found = myTree.lower_bound(item);
+    if (found == myTree.end())
+        return std::nullopt;
+    return *found;
+}
+
+//--- Definition of inorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+void ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::inorder(std::ostream& out,
+                                                                                       std::string_view separator) const
+{
+    std::shared_lock<std::shared_mutex> lock(myMutex);
+    myTree.for_each_inorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of for_each_inorder()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+inline bool ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::for_each_inorder(Visitor&& visit) const
+{
+    std::shared_lock<std::shared_mutex> lock(myMutex);
+    return myTree.for_each_inorder(std::forward<Visitor>(visit));
+}
+
+//--- Definition of range()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename Visitor>
+inline bool ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::range(const DataType& low,
+                                                                                            const DataType& high,
+                                                                                            Visitor&& visit) const
+{
+    std::shared_lock<std::shared_mutex> lock(myMutex);
+    return myTree.range(low, high, std::forward<Visitor>(visit));
+}
+
+//--- Definition of insert()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::insert(const DataType& item)
+{
+    std::unique_lock<std::shared_mutex> lock(myMutex);
+    myTree.insert(item);
+}
+
+//--- Definition of try_insert()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline bool ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::try_insert(const DataType& item)
+{
+    std::unique_lock<std::shared_mutex> lock(myMutex);
+    return myTree.try_insert(item).second;
+}
+
+//--- Definition of remove()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::remove(const DataType& item)
+{
+    std::unique_lock<std::shared_mutex> lock(myMutex);
+    myTree.remove(item);
+}
+
+//--- Definition of try_erase()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline bool ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::try_erase(const DataType& item)
+{
+    std::unique_lock<std::shared_mutex> lock(myMutex);
+    return myTree.try_erase(item);
+}
+
+//--- Definition of clear()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline void ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(myMutex);
+    myTree.clear();
+}
+
+//--- Definition of read()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename F>
+inline decltype(auto) ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::read(F&& f) const
+{
+    std::shared_lock<std::shared_mutex> lock(myMutex);
+    return std::invoke(std::forward<F>(f), std::as_const(myTree));
+}
+
+//--- Definition of write()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+template <typename F>
+inline decltype(auto) ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::write(F&& f)
+{
+    std::unique_lock<std::shared_mutex> lock(myMutex);
+    return std::invoke(std::forward<F>(f), myTree);
+}
+
+//--- Definition of snapshot()
+template <typename DataType, typename Alloc, typename Balance, typename Compare, bool OrderStatistics, typename Augment>
+inline typename ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::tree_type
+ConcurrentBST<DataType, Alloc, Balance, Compare, OrderStatistics, Augment>::snapshot() const
+{
+    std::shared_lock<std::shared_mutex> lock(myMutex);
+    return tree_type(myTree);
+}
+
+#endif  // CONCURRENTBST_H_
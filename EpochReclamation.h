@@ -0,0 +1,247 @@
+/**
+ * @file EpochReclamation.h
+ * @brief Declaration of class EpochDomain.
+ *
+ * This file contains an epoch-based reclamation scheme for lock-free data
+ * structures such as LockFreeBST.  A thread pins the current epoch for the
+ * duration of an operation; objects unlinked from a structure are retired
+ * instead of deleted, and are only freed once every thread has moved on
+ * from the epoch in which they were retired, so no pinned thread can still
+ * be reading them.
+ *
+ * Basic operations include:
+ * - Guard: Pins the current epoch for the lifetime of the guard
+ * - retire: Hands over an unlinked object to be freed once it is safe
+ *
+ * Freed objects are kept in three per-thread lists, one for each of the
+ * last three epochs.  The global epoch only advances once every pinned
+ * thread has observed it, so an object retired in epoch e can be freed
+ * when the global epoch reaches e + 2.
+ */
+
+#ifndef EPOCHRECLAMATION_H_
+#define EPOCHRECLAMATION_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class EpochDomain
+ * @brief Process-wide epoch-based reclamation domain.
+ *
+ * Threads register on first use and release their slot when they exit;
+ * objects they retired but could not free yet are freed by the next thread
+ * taking over the slot, or when the domain is destroyed at program exit.
+ */
+class EpochDomain
+{
+public:
+    /**
+     * @class Guard
+     * @brief Pins the current epoch while it is alive.  Guards may nest.
+     */
+    class Guard
+    {
+    public:
+        explicit Guard(EpochDomain& domain)
+            : myDomain(domain)
+        {
+            myDomain.enter();
+        }
+
+        ~Guard()
+        {
+            myDomain.leave();
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        EpochDomain& myDomain;
+    };
+
+    /**
+     * @brief Returns the process-wide domain.
+     */
+    static EpochDomain& instance()
+    {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    /**
+     * @brief Frees everything still retired.  No thread may be using the
+     *        domain any more.
+     */
+    ~EpochDomain()
+    {
+        ThreadRecord* record = myRecords.load();
+        while (record != nullptr)
+        {
+            for (std::vector<Retired>& list : record->limbo)
+                release(list);
+            ThreadRecord* next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+    /**
+     * @brief Schedules an unlinked object to be freed once no pinned thread
+     *        can still be reading it.
+     *
+     * @param object The object; no new references to it may be created.
+     * @param deleter Function that frees the object.
+     */
+    void retire(void* object, void (*deleter)(void*))
+    {
+        ThreadRecord& self = record();
+        std::uint64_t epoch = myEpoch.load();
+        std::size_t bucket = epoch % 3;
+        if (self.limboEpoch[bucket] != epoch)
+        {                               // holds epoch - 3 or older: safe to free
+            release(self.limbo[bucket]);
+            self.limboEpoch[bucket] = epoch;
+        }
+        self.limbo[bucket].push_back(Retired{object, deleter});
+
+        if (++self.retiredSinceAdvance >= advanceInterval)
+        {
+            self.retiredSinceAdvance = 0;
+            tryAdvance();
+            collect(self);
+        }
+    }
+
+    /**
+     * @brief Schedules an unlinked object allocated with new to be deleted.
+     */
+    template <typename T>
+    void retire(T* object)
+    {
+        retire(object, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+private:
+    /***** An object waiting to be freed *****/
+    struct Retired
+    {
+        void* object;
+        void (*deleter)(void*);
+    };
+
+    /***** Per-thread state *****/
+    struct ThreadRecord
+    {
+        std::atomic<std::uint64_t> epoch{0};     // (pinned epoch << 1) | pinned
+        std::atomic<bool> inUse{true};
+        unsigned nesting = 0;                    // depth of nested guards
+        unsigned retiredSinceAdvance = 0;
+        std::vector<Retired> limbo[3];           // indexed by epoch % 3
+        std::uint64_t limboEpoch[3] = {0, 0, 0}; // epoch of each limbo list
+        ThreadRecord* next = nullptr;
+    };
+
+    /***** Retirements between attempts to advance the epoch *****/
+    static constexpr unsigned advanceInterval = 64;
+
+    EpochDomain() = default;
+
+    /**
+     * Returns the calling thread's record, registering the thread on first use.
+     */
+    ThreadRecord& record()
+    {
+        struct Slot
+        {
+            ThreadRecord* record = nullptr;
+            ~Slot()
+            {
+                if (record != nullptr)
+                    record->inUse.store(false);
+            }
+        };
+        thread_local Slot slot;
+        if (slot.record == nullptr)
+            slot.record = acquireRecord();
+        return *slot.record;
+    }
+
+    /**
+     * Takes over the record of an exited thread, or adds a new one.
+     */
+    ThreadRecord* acquireRecord()
+    {
+        for (ThreadRecord* r = myRecords.load(); r != nullptr; r = r->next)
+        {
+            bool unused = false;
+            if (r->inUse.compare_exchange_strong(unused, true))
+                return r;
+        }
+        ThreadRecord* r = new ThreadRecord;
+        r->next = myRecords.load();
+        while (!myRecords.compare_exchange_weak(r->next, r))
+        {}
+        return r;
+    }
+
+    void enter()
+    {
+        ThreadRecord& self = record();
+        if (self.nesting++ == 0)
+            self.epoch.store(myEpoch.load() << 1 | 1);
+    }
+
+    void leave()
+    {
+        ThreadRecord& self = record();
+        if (--self.nesting == 0)
+            self.epoch.store(0);
+    }
+
+    /**
+     * Advances the global epoch if every pinned thread has observed it.
+     */
+    bool tryAdvance()
+    {
+        std::uint64_t epoch = myEpoch.load();
+        for (ThreadRecord* r = myRecords.load(); r != nullptr; r = r->next)
+        {
+            std::uint64_t local = r->epoch.load();
+            if ((local & 1) != 0 && (local >> 1) != epoch)
+                return false;
+        }
+        return myEpoch.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    /**
+     * Frees the calling thread's lists that are at least two epochs old.
+     */
+    void collect(ThreadRecord& self)
+    {
+        std::uint64_t epoch = myEpoch.load();
+        for (std::size_t bucket = 0; bucket < 3; ++bucket)
+        {
+            if (self.limboEpoch[bucket] + 2 <= epoch)
+                release(self.limbo[bucket]);
+        }
+    }
+
+    static void release(std::vector<Retired>& list)
+    {
+        for (const Retired& retired : list)
+            retired.deleter(retired.object);
+        list.clear();
+    }
+
+    /***** Data Members *****/
+    std::atomic<std::uint64_t> myEpoch{0};
+    std::atomic<ThreadRecord*> myRecords{nullptr};
+};
+
+#endif  // EPOCHRECLAMATION_H_
@@ -0,0 +1,262 @@
+/**
+ * @file FrozenBST.h
+ * @brief Declaration of class template FrozenBST.
+ *
+ * This file contains the declaration of the class template FrozenBST, an
+ * immutable snapshot of the items of a BST (see BST::freeze).  The items are
+ * stored contiguously in Eytzinger (breadth-first) order: the children of
+ * the item at 1-based position k are at 2k and 2k + 1.  A descent therefore
+ * touches memory in a predictable pattern, needs no pointers, and can
+ * prefetch the cache line holding the next four levels while comparing.
+ *
+ * Basic operations include:
+ * - Constructor: Builds a snapshot from a sorted range
+ * - size, empty: Number of items in the snapshot
+ * - search: Search the snapshot for an item
+ * - lower_bound, upper_bound: Ordered position queries
+ */
+
+#ifndef FROZENBST_H_
+#define FROZENBST_H_
+
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @class FrozenBST
+ * @brief A read-only, cache-friendly search structure over sorted items.
+ *
+ * Lookups use branchless descents: each level computes the next position
+ * arithmetically from one comparison instead of branching on it.
+ *
+ * @tparam DataType Type of the stored items.
+ * @tparam Compare Strict weak ordering of the items.
+ */
+template <typename DataType, typename Compare = std::less<>>
+class FrozenBST
+{
+public:
+    /**
+     * @brief Constructs an empty snapshot.
+     */
+    FrozenBST();
+
+    /**
+     * @brief Builds a snapshot from a sorted range of unique items.
+     *
+     * @param first Start of a range of strictly increasing items.
+     * @param last End of the range.
+     * @param compare Comparator the range is sorted by (optional).
+     */
+    template <typename ForwardIt>
+    FrozenBST(ForwardIt first, ForwardIt last, const Compare& compare = Compare());
+
+    /**
+     * @brief Returns the number of items in the snapshot.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Checks if the snapshot is empty.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Searches for a given item in the snapshot.
+     *
+     * @param item The item to search for.
+     * @return true if the item is found, false otherwise.
+     */
+    bool search(const DataType& item) const;
+
+    /**
+     * @brief Finds the first item not less than the given item.
+     *
+     * @param item The item to compare against.
+     * @return Pointer to the first item >= item, or nullptr if there is none.
+     */
+    const DataType* lower_bound(const DataType& item) const;
+
+    /**
+     * @brief Finds the first item greater than the given item.
+     *
+     * @param item The item to compare against.
+     * @return Pointer to the first item > item, or nullptr if there is none.
+     */
+    const DataType* upper_bound(const DataType& item) const;
+
+private:
+    /**
+     * Places the next items of a sorted sequence at the Eytzinger positions
+     * of the subtree rooted at 1-based position k, in order.
+     */
+    template <typename ForwardIt>
+    void fillAux(ForwardIt& next, std::size_t k);
+
+    /**
+     * Records, in order, which sorted index lands at each Eytzinger position
+     * of the subtree rooted at 1-based position k.
+     */
+    void orderAux(std::vector<std::size_t>& sortedIndex, std::size_t& next, std::size_t k) const;
+
+    /**
+     * Maps the position reached when a descent runs off the bottom of the
+     * tree back to the last position where it turned left.
+     *
+     * @param k Position past the last level (at least size() + 1).
+     * @return Pointer to the item there, or nullptr if the descent never turned left.
+     */
+    const DataType* resolve(std::size_t k) const;
+
+    /**
+     * Hints that the items four levels below position k will be read soon.
+     */
+    void prefetch(std::size_t k) const;
+
+    /***** Data Members *****/
+    std::vector<DataType> myItems;   // Eytzinger position k stored at index k - 1
+    [[no_unique_address]] Compare myCompare;
+
+}; // end of class template declaration
+
+//--- Definition of constructor
+template <typename DataType, typename Compare>
+inline FrozenBST<DataType, Compare>::FrozenBST()
+    : myCompare()
+{}
+
+//--- Definition of range constructor
+template <typename DataType, typename Compare>
+template <typename ForwardIt>
+FrozenBST<DataType, Compare>::FrozenBST(ForwardIt first, ForwardIt last, const Compare& compare)
+    : myCompare(compare)
+{
+    std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+    if constexpr (std::is_default_constructible_v<DataType>)
+    {                                   // fill the final slots directly
+        myItems.resize(count);
+        fillAux(first, 1);
+    }
+    else
+    {                                   // gather, then copy in Eytzinger order
+        std::vector<std::size_t> sortedIndex(count);
+        std::size_t next = 0;
+        orderAux(sortedIndex, next, 1);
+        std::vector<ForwardIt> positions;
+        positions.reserve(count);
+        for (; first != last; ++first)
+            positions.push_back(first);
+        myItems.reserve(count);
+        for (std::size_t index : sortedIndex)
+            myItems.push_back(*positions[index]);
+    }
+}
+
+//--- Definition of size()
+template <typename DataType, typename Compare>
+inline std::size_t FrozenBST<DataType, Compare>::size() const
+{
+    return myItems.size();
+}
+
+//--- Definition of empty()
+template <typename DataType, typename Compare>
+inline bool FrozenBST<DataType, Compare>::empty() const
+{
+    return myItems.empty();
+}
+
+//--- Definition of search()
+template <typename DataType, typename Compare>
+inline bool FrozenBST<DataType, Compare>::search(const DataType& item) const
+{
+    const DataType* found = lower_bound(item);
+    return found != nullptr && !myCompare(item, *found);
+}
+
+//--- Definition of lower_bound()
+template <typename DataType, typename Compare>
+const DataType* FrozenBST<DataType, Compare>::lower_bound(const DataType& item) const
+{
+    const DataType* items = myItems.data();
+    std::size_t n = myItems.size(),
+                k = 1;
+    while (k <= n)
+    {
+        prefetch(k);
+        k = 2 * k + myCompare(items[k - 1], item);   // right when the item is larger
+    }
+    return resolve(k);
+}
+
+//--- Definition of upper_bound()
+template <typename DataType, typename Compare>
+const DataType* FrozenBST<DataType, Compare>::upper_bound(const DataType& item) const
+{
+    const DataType* items = myItems.data();
+    std::size_t n = myItems.size(),
+                k = 1;
+    while (k <= n)
+    {
+        prefetch(k);
+        k = 2 * k + !myCompare(item, items[k - 1]);  // right unless the item is smaller
+    }
+    return resolve(k);
+}
+
+//--- Definition of fillAux()
+template <typename DataType, typename Compare>
+template <typename ForwardIt>
+void FrozenBST<DataType, Compare>::fillAux(ForwardIt& next, std::size_t k)
+{
+    if (k <= myItems.size())
+    {
+        fillAux(next, 2 * k);
+        myItems[k - 1] = *next;
+        ++next;
+        fillAux(next, 2 * k + 1);
+    }
+}
+
+//--- Definition of orderAux()
+template <typename DataType, typename Compare>
+void FrozenBST<DataType, Compare>::orderAux(std::vector<std::size_t>& sortedIndex,
+                                            std::size_t& next, std::size_t k) const
+{
+    if (k <= sortedIndex.size())
+    {
+        orderAux(sortedIndex, next, 2 * k);
+        sortedIndex[k - 1] = next++;
+        orderAux(sortedIndex, next, 2 * k + 1);
+    }
+}
+
+//--- Definition of resolve()
+template <typename DataType, typename Compare>
+inline const DataType* FrozenBST<DataType, Compare>::resolve(std::size_t k) const
+{
+    // The path is encoded in the bits of k (1 = went right).  Dropping the
+    // trailing right turns and the left turn before them gives the answer.
+    k >>= std::countr_one(k) + 1;
+    return k == 0 ? nullptr : &myItems[k - 1];
+}
+
+//--- Definition of prefetch()
+template <typename DataType, typename Compare>
+inline void FrozenBST<DataType, Compare>::prefetch(std::size_t k) const
+{
+#if defined(__GNUC__)
+    // The 16 descendants four levels down are adjacent, starting at 16k
+    if (16 * k <= myItems.size())
+        __builtin_prefetch(myItems.data() + 16 * k - 1);
+#else
+    (void)k;
+#endif
+}
+
+#endif  // FROZENBST_H_
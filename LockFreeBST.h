@@ -0,0 +1,446 @@
+/**
+ * @file LockFreeBST.h
+ * @brief Declaration of class template LockFreeBST.
+ *
+ * This file contains a lock-free binary search tree after Natarajan and
+ * Mittal, "Fast Concurrent Lock-Free Binary Search Trees" (PPoPP 2014).
+ * The tree is external: items live in the leaves, and internal nodes only
+ * route searches.  Every child link carries two mark bits:
+ * - flag: the leaf below is being removed
+ * - tag: the link is frozen because its node is being unlinked
+ *
+ * Basic operations include:
+ * - search: Lock-free lookup that never writes to shared memory
+ * - try_insert: Replaces a leaf by a router with the old and the new leaf
+ *   as children, in one compare-and-swap
+ * - try_erase: Flags the leaf's link, then unlinks the leaf and its parent
+ *   by swinging the link above them to the sibling; any thread that runs
+ *   into a marked link helps to finish the removal
+ * - for_each_inorder, empty: Inspection while no updates are running
+ *
+ * Unlinked nodes are handed to the process-wide EpochDomain (see
+ * EpochReclamation.h) rather than deleted, so concurrent readers never
+ * touch freed memory.
+ */
+
+#ifndef LOCKFREEBST_H_
+#define LOCKFREEBST_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "EpochReclamation.h"
+
+/**
+ * @class LockFreeBST
+ * @brief A set of items that many threads may search and update at once.
+ *
+ * Nodes come from operator new, which, unlike PoolAllocator, may be
+ * called from many threads at once.  The tree is not balanced.
+ *
+ * @tparam DataType Type of the stored items.
+ * @tparam Compare Strict weak ordering of the items.
+ */
+template <typename DataType, typename Compare = std::less<>>
+class LockFreeBST
+{
+public:
+    /**
+     * @brief Constructs an empty tree.
+     *
+     * @param compare Comparator ordering the items (optional).
+     */
+    explicit LockFreeBST(const Compare& compare = Compare());
+
+    LockFreeBST(const LockFreeBST&) = delete;
+    LockFreeBST& operator=(const LockFreeBST&) = delete;
+
+    /**
+     * @brief Frees every node.  No other thread may be using the tree.
+     */
+    ~LockFreeBST();
+
+    /**
+     * @brief Searches for a given item.
+     *
+     * @param item The item to search for.
+     * @return true if the item is found, false otherwise.
+     */
+    bool search(const DataType& item) const;
+
+    /**
+     * @brief Inserts an item if no equal item is present.
+     *
+     * @param item The item to be inserted.
+     * @return true if the item was inserted, false if it was already present.
+     */
+    bool try_insert(const DataType& item);
+
+    /**
+     * @brief Removes an item if present.
+     *
+     * @param item The item to be removed.
+     * @return true if the item was removed, false if it was not in the tree.
+     */
+    bool try_erase(const DataType& item);
+
+    /**
+     * @brief Checks if the tree is empty.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Calls visit on every item in order.
+     *
+     * Only meaningful while no updates are running; concurrent updates may
+     * or may not be observed.  A visitor returning bool stops the traversal
+     * early by returning false.
+     *
+     * @param visit Callable invoked as visit(item) for each item.
+     * @return false if visit stopped the traversal early, true otherwise.
+     */
+    template <typename Visitor>
+    bool for_each_inorder(Visitor&& visit) const;
+
+private:
+    /***** Node structure *****/
+    class Node
+    {
+    public:
+        std::optional<DataType> key;           // empty for the +infinity sentinels
+        std::atomic<std::uintptr_t> left;      // marked links; 0 in a leaf
+        std::atomic<std::uintptr_t> right;
+
+        // Leaf holding key (or a sentinel, if key is empty)
+        explicit Node(std::optional<DataType> item)
+            : key(std::move(item)), left(0), right(0)
+        {}
+
+        // Router between two subtrees
+        Node(std::optional<DataType> item, Node* leftChild, Node* rightChild)
+            : key(std::move(item)),
+              left(reinterpret_cast<std::uintptr_t>(leftChild)),
+              right(reinterpret_cast<std::uintptr_t>(rightChild))
+        {}
+    };
+
+    /***** Nodes found by a search, see seek() *****/
+    struct SeekRecord
+    {
+        Node* ancestor;    // parent of successor, reached by an unmarked link
+        Node* successor;   // top of the chain unlinked by a removal below
+        Node* parent;      // parent of leaf
+        Node* leaf;        // where the search ended
+    };
+
+    /***** Mark bits in the low bits of a link *****/
+    static constexpr std::uintptr_t flagBit = 1;
+    static constexpr std::uintptr_t tagBit = 2;
+
+    /**
+     * Strips the mark bits from a link.
+     */
+    static Node* address(std::uintptr_t link);
+
+    /**
+     * Checks whether item routes to the left of node (true for every item
+     * at a sentinel).
+     */
+    bool routesLeft(const DataType& item, const Node* node) const;
+
+    /**
+     * Checks whether leaf holds an item equal to item.
+     */
+    bool holds(const Node* leaf, const DataType& item) const;
+
+    /**
+     * Returns the link of node on item's side.
+     */
+    std::atomic<std::uintptr_t>& childLink(Node* node, const DataType& item) const;
+
+    /**
+     * Descends to the leaf where item is or would be stored, recording
+     * the last unmarked link on the way.  Must run inside an epoch guard.
+     */
+    SeekRecord seek(const DataType& item) const;
+
+    /**
+     * Finishes the removal of a flagged leaf below record.parent by tagging
+     * its sibling's link and swinging the link to record.successor over to
+     * the sibling.
+     *
+     * @return true if this call unlinked the nodes.
+     */
+    bool cleanup(const DataType& item, const SeekRecord& record);
+
+    /**
+     * Retires the nodes unlinked by a successful cleanup: the routers from
+     * successor down to parent, and the flagged leaf below each of them.
+     *
+     * @param kept The child of parent that was moved up.
+     */
+    void retireChain(const DataType& item, Node* successor, Node* parent, Node* kept);
+
+    /***** Data Members *****/
+    Node* myRoot;            // sentinel router R; its left child is S
+    Node* mySentinel;        // sentinel router S; items live below S->left
+    [[no_unique_address]] Compare myCompare;
+};
+
+//--- Definition of constructor
+template <typename DataType, typename Compare>
+LockFreeBST<DataType, Compare>::LockFreeBST(const Compare& compare)
+    : myRoot(nullptr), mySentinel(nullptr), myCompare(compare)
+{
+    // All three sentinel leaves are greater than any item, so items always
+    // route left at R and S.
+    mySentinel = new Node(std::nullopt, new Node(std::nullopt), new Node(std::nullopt));
+    myRoot = new Node(std::nullopt, mySentinel, new Node(std::nullopt));
+}
+
+//--- Definition of destructor
+template <typename DataType, typename Compare>
+LockFreeBST<DataType, Compare>::~LockFreeBST()
+{
+    std::vector<Node*> pending{myRoot};
+    while (!pending.empty())
+    {
+        Node* node = pending.back();
+        pending.pop_back();
+        if (Node* child = address(node->left.load()))
+            pending.push_back(child);
+        if (Node* child = address(node->right.load()))
+            pending.push_back(child);
+        delete node;
+    }
+}
+
+//--- Definition of search()
+template <typename DataType, typename Compare>
+bool LockFreeBST<DataType, Compare>::search(const DataType& item) const
+{
+    EpochDomain::Guard guard(EpochDomain::instance());
+    return holds(seek(item).leaf, item);
+}
+
+//--- Definition of try_insert()
+template <typename DataType, typename Compare>
+bool LockFreeBST<DataType, Compare>::try_insert(const DataType& item)
+{
+    EpochDomain::Guard guard(EpochDomain::instance());
+    Node* newLeaf = nullptr;
+    Node* newRouter = nullptr;
+    while (true)
+    {
+        SeekRecord record = seek(item);
+        Node* leaf = record.leaf;
+        if (holds(leaf, item))
+        {                               // never published -- free directly
+            delete newLeaf;
+            delete newRouter;
+            return false;
+        }
+
+        // The router takes the larger key, with the smaller leaf on its left
+        if (newLeaf == nullptr)
+        {
+            newLeaf = new Node(item);
+            newRouter = new Node(std::nullopt, nullptr, nullptr);
+        }
+        bool leafFirst = !routesLeft(item, leaf);
+        newRouter->key = leafFirst ? newLeaf->key : leaf->key;
+        newRouter->left.store(reinterpret_cast<std::uintptr_t>(leafFirst ? leaf : newLeaf));
+        newRouter->right.store(reinterpret_cast<std::uintptr_t>(leafFirst ? newLeaf : leaf));
+
+        std::atomic<std::uintptr_t>& link = childLink(record.parent, item);
+        std::uintptr_t expected = reinterpret_cast<std::uintptr_t>(leaf);
+        if (link.compare_exchange_strong(expected, reinterpret_cast<std::uintptr_t>(newRouter)))
+            return true;
+
+        // The leaf is being removed -- help, then retry
+        if (address(expected) == leaf && (expected & (flagBit | tagBit)) != 0)
+            cleanup(item, record);
+    }
+}
+
+//--- Definition of try_erase()
+template <typename DataType, typename Compare>
+bool LockFreeBST<DataType, Compare>::try_erase(const DataType& item)
+{
+    EpochDomain::Guard guard(EpochDomain::instance());
+    Node* leaf = nullptr;               // set once our flag is in place
+    while (true)
+    {
+        SeekRecord record = seek(item);
+        if (leaf == nullptr)
+        {                               // injection: flag the link to the leaf
+            if (!holds(record.leaf, item))
+                return false;
+            std::atomic<std::uintptr_t>& link = childLink(record.parent, item);
+            std::uintptr_t expected = reinterpret_cast<std::uintptr_t>(record.leaf);
+            if (link.compare_exchange_strong(expected, expected | flagBit))
+            {
+                leaf = record.leaf;
+                if (cleanup(item, record))
+                    return true;
+            }
+            else if (address(expected) == record.leaf && (expected & (flagBit | tagBit)) != 0)
+                cleanup(item, record);
+        }
+        else if (record.leaf != leaf)   // cleanup: another thread finished it
+            return true;
+        else if (cleanup(item, record))
+            return true;
+    }
+}
+
+//--- Definition of empty()
+template <typename DataType, typename Compare>
+bool LockFreeBST<DataType, Compare>::empty() const
+{
+    EpochDomain::Guard guard(EpochDomain::instance());
+    // With no items, S->left is the sentinel leaf
+    return address(mySentinel->left.load())->left.load() == 0;
+}
+
+//--- Definition of for_each_inorder()
+template <typename DataType, typename Compare>
+template <typename Visitor>
+bool LockFreeBST<DataType, Compare>::for_each_inorder(Visitor&& visit) const
+{
+    EpochDomain::Guard guard(EpochDomain::instance());
+    std::vector<Node*> pending{address(mySentinel->left.load())};
+    while (!pending.empty())
+    {
+        Node* node = pending.back();
+        pending.pop_back();
+        Node* leftChild = address(node->left.load());
+        if (leftChild != nullptr)
+        {                               // router -- right pops after left
+            pending.push_back(address(node->right.load()));
+            pending.push_back(leftChild);
+        }
+        else if (node->key.has_value())
+        {
+            if constexpr (std::is_same_v<std::invoke_result_t<Visitor&, const DataType&>, bool>)
+            {
+                if (!visit(*node->key))
+                    return false;
+            }
+            else
+                visit(*node->key);
+        }
+    }
+    return true;
+}
+
+//--- Definition of address()
+template <typename DataType, typename Compare>
+inline typename LockFreeBST<DataType, Compare>::Node* LockFreeBST<DataType, Compare>::address(std::uintptr_t link)
+{
+    return reinterpret_cast<Node*>(link & ~(flagBit | tagBit));
+}
+
+//--- Definition of routesLeft()
+template <typename DataType, typename Compare>
+inline bool LockFreeBST<DataType, Compare>::routesLeft(const DataType& item, const Node* node) const
+{
+    return !node->key.has_value() || myCompare(item, *node->key);
+}
+
+//--- Definition of holds()
+template <typename DataType, typename Compare>
+inline bool LockFreeBST<DataType, Compare>::holds(const Node* leaf, const DataType& item) const
+{
+    return leaf->key.has_value() && !myCompare(item, *leaf->key) && !myCompare(*leaf->key, item);
+}
+
+//--- Definition of childLink()
+template <typename DataType, typename Compare>
+inline std::atomic<std::uintptr_t>& LockFreeBST<DataType, Compare>::childLink(Node* node,
+                                                                           const DataType& item) const
+{
+    return routesLeft(item, node) ? node->left : node->right;
+}
+
+//--- Definition of seek()
+template <typename DataType, typename Compare>
+typename LockFreeBST<DataType, Compare>::SeekRecord
+LockFreeBST<DataType, Compare>::seek(const DataType& item) const
+{
+    SeekRecord record{myRoot, mySentinel, mySentinel, nullptr};
+    std::uintptr_t parentLink = mySentinel->left.load();
+    record.leaf = address(parentLink);
+    std::uintptr_t currentLink = record.leaf->left.load();
+    Node* current = address(currentLink);
+    while (current != nullptr)
+    {
+        // An unmarked link above leaf means nothing above it is being unlinked
+        if ((parentLink & tagBit) == 0)
+        {
+            record.ancestor = record.parent;
+            record.successor = record.leaf;
+        }
+        record.parent = record.leaf;
+        record.leaf = current;
+        parentLink = currentLink;
+        currentLink = childLink(current, item).load();
+        current = address(currentLink);
+    }
+    return record;
+}
+
+//--- Definition of cleanup()
+template <typename DataType, typename Compare>
+bool LockFreeBST<DataType, Compare>::cleanup(const DataType& item, const SeekRecord& record)
+{
+    Node* parent = record.parent;
+    std::atomic<std::uintptr_t>& successorLink = childLink(record.ancestor, item);
+    std::atomic<std::uintptr_t>* childPtr = &parent->left;
+    std::atomic<std::uintptr_t>* siblingPtr = &parent->right;
+    if (!routesLeft(item, parent))
+        std::swap(childPtr, siblingPtr);
+    // If item's leaf is not the flagged one, its sibling is, and item's
+    // side is the one that moves up
+    if ((childPtr->load() & flagBit) == 0)
+        siblingPtr = childPtr;
+
+    siblingPtr->fetch_or(tagBit);         // freeze the link that moves up
+    std::uintptr_t sibling = siblingPtr->load();
+    std::uintptr_t expected = reinterpret_cast<std::uintptr_t>(record.successor);
+    if (!successorLink.compare_exchange_strong(expected, sibling & ~tagBit))  // keeps the flag
+        return false;
+    retireChain(item, record.successor, parent, address(sibling));
+    return true;
+}
+
+//--- Definition of retireChain()
+template <typename DataType, typename Compare>
+void LockFreeBST<DataType, Compare>::retireChain(const DataType& item, Node* successor, Node* parent, Node* kept)
+{
+    // Every link in the chain is marked, so it can no longer change
+    EpochDomain& domain = EpochDomain::instance();
+    Node* node = successor;
+    while (true)
+    {
+        Node* leftChild = address(node->left.load());
+        Node* rightChild = address(node->right.load());
+        if (node == parent)
+        {
+            domain.retire(leftChild == kept ? rightChild : leftChild);
+            domain.retire(node);
+            return;
+        }
+        bool left = routesLeft(item, node);
+        domain.retire(left ? rightChild : leftChild);   // a flagged leaf
+        domain.retire(node);
+        node = left ? leftChild : rightChild;
+    }
+}
+
+#endif  // LOCKFREEBST_H_
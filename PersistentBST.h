@@ -0,0 +1,707 @@
+/**
+ * @file PersistentBST.h
+ * @brief Declaration of class template PersistentBST.
+ *
+ * This file contains the declaration of the class template PersistentBST, a
+ * balanced binary search tree whose nodes are never modified once built.
+ * An update copies only the nodes on the path from the root to the changed
+ * item (O(log n) of them) and shares every other subtree with the previous
+ * version, so taking a snapshot is just copying the root pointer.
+ *
+ * Basic operations include:
+ * - Constructor: Constructs an empty tree
+ * - Copy constructor, assignment operator, snapshot: O(1) copies that share
+ *   all nodes with the original
+ * - empty, size: Number of items in O(1)
+ * - search: Search the tree for an item
+ * - insert, remove: Insert or remove an item by copying its path
+ * - try_insert, try_erase: Non-throwing insert and remove reporting the outcome
+ * - clear: Drops this version's reference to its nodes
+ * - inorder, preorder, postorder: Depth-first traversals -- output the
+ *   data values
+ * - levelorder: Level-by-level traversal -- output the data values
+ * - for_each_inorder, for_each_preorder, for_each_postorder,
+ *   for_each_levelorder: Traversals calling a visitor, with early exit
+ * - graph: Output a graphical representation of the tree
+ * - lower_bound: Ordered position query
+ * - range: Visit the data values in a half-open interval
+ *
+ * Nodes are reference counted (std::shared_ptr) and freed when the last
+ * version using them goes away.  The tree is kept balanced with the AVL
+ * rule, so every operation is O(log n).
+ */
+
+#ifndef PERSISTENTBST_H_
+#define PERSISTENTBST_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @class PersistentBST
+ * @brief A BST with O(1) snapshots that stay valid while the tree changes.
+ *
+ * A single PersistentBST object is not synchronized, but versions never
+ * share mutable state: a snapshot may be read by other threads while the
+ * tree it was taken from keeps being updated.
+ *
+ * @tparam DataType Type of the stored items (copy constructible).
+ * @tparam Compare Strict weak ordering of the items.
+ */
+template <typename DataType, typename Compare = std::less<>>
+class PersistentBST
+{
+public:
+    /**
+     * @brief Constructs an empty tree.
+     *
+     * @param compare Comparator ordering the items (optional).
+     */
+    explicit PersistentBST(const Compare& compare = Compare());
+
+    /**
+     * @brief Returns the current version.  O(1); nothing is copied.
+     *
+     * The snapshot is unaffected by later updates to this tree, and the
+     * other way round.
+     */
+    PersistentBST snapshot() const;
+
+    /**
+     * @brief Checks if the tree is empty.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Returns the number of items in the tree.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Searches for a given item.
+     *
+     * @param item The item to search for.
+     * @return true if the item is found, false otherwise.
+     */
+    bool search(const DataType& item) const;
+
+    /**
+     * @brief Inserts an item.
+     *
+     * @param item The item to be inserted.
+     * @throws std::runtime_error if the item is already in the tree.
+     */
+    void insert(const DataType& item);
+
+    /**
+     * @brief Inserts an item if no equal item is present.
+     *
+     * @param item The item to be inserted.
+     * @return true if the item was inserted, false if it was already present.
+     */
+    bool try_insert(const DataType& item);
+
+    /**
+     * @brief Removes an item.
+     *
+     * @param item The item to be removed.
+     * @throws std::runtime_error if the item is not in the tree.
+     */
+    void remove(const DataType& item);
+
+    /**
+     * @brief Removes an item if present.
+     *
+     * @param item The item to be removed.
+     * @return true if the item was removed, false if it was not in the tree.
+     */
+    bool try_erase(const DataType& item);
+
+    /**
+     * @brief Empties this version.  Snapshots keep their items.
+     */
+    void clear();
+
+    /**
+     * @brief Outputs the data values in order.
+     *
+     * @param out The output stream.
+     * @param separator Text written after each item (optional).
+     */
+    void inorder(std::ostream& out, std::string_view separator = "  ") const;
+
+    /**
+     * @brief Outputs the data values in preorder.
+     *
+     * @param out The output stream.
+     * @param separator Text written after each item (optional).
+     */
+    void preorder(std::ostream& out, std::string_view separator = "  ") const;
+
+    /**
+     * @brief Outputs the data values in postorder.
+     *
+     * @param out The output stream.
+     * @param separator Text written after each item (optional).
+     */
+    void postorder(std::ostream& out, std::string_view separator = "  ") const;
+
+    /**
+     * @brief Outputs the data values level by level, top to bottom and left
+     *        to right within a level.
+     *
+     * @param out The output stream.
+     * @param separator Text written after each item (optional).
+     */
+    void levelorder(std::ostream& out, std::string_view separator = "  ") const;
+
+    /**
+     * @brief Calls visit on every item in order.
+     *
+     * @param visit Callable invoked as visit(item); a visitor returning
+     *              bool stops early by returning false.
+     * @return false if visit stopped early, true otherwise.
+     */
+    template <typename Visitor>
+    bool for_each_inorder(Visitor&& visit) const;
+
+    /**
+     * @brief Calls visit on every item in preorder.
+     *
+     * @param visit Callable invoked as visit(item); a visitor returning
+     *              bool stops early by returning false.
+     * @return false if visit stopped early, true otherwise.
+     */
+    template <typename Visitor>
+    bool for_each_preorder(Visitor&& visit) const;
+
+    /**
+     * @brief Calls visit on every item in postorder.
+     *
+     * @param visit Callable invoked as visit(item); a visitor returning
+     *              bool stops early by returning false.
+     * @return false if visit stopped early, true otherwise.
+     */
+    template <typename Visitor>
+    bool for_each_postorder(Visitor&& visit) const;
+
+    /**
+     * @brief Calls visit on every item level by level.
+     *
+     * @param visit Callable invoked as visit(item); a visitor returning
+     *              bool stops early by returning false.
+     * @return false if visit stopped early, true otherwise.
+     */
+    template <typename Visitor>
+    bool for_each_levelorder(Visitor&& visit) const;
+
+    /**
+     * @brief Prints the tree sideways, root at the left and the right
+     *        subtree on top, in the format of BST::graph.
+     *
+     * @param out The output stream.
+     */
+    void graph(std::ostream& out) const;
+
+    /**
+     * @brief Finds the first item not less than the given item.
+     *
+     * @param item The item to compare against.
+     * @return Pointer to the first item >= item, or nullptr if there is
+     *         none.  Valid as long as this version is not updated or destroyed.
+     */
+    const DataType* lower_bound(const DataType& item) const;
+
+    /**
+     * @brief Visits, in order, every item in the half-open interval [low, high).
+     *
+     * @param low Smallest item to visit.
+     * @param high Items not less than high are not visited.
+     * @param visit Callable invoked as visit(item) for each item in range;
+     *              a visitor returning bool stops early by returning false.
+     * @return false if visit stopped early, true otherwise.
+     */
+    template <typename Visitor>
+    bool range(const DataType& low, const DataType& high, Visitor&& visit) const;
+
+private:
+    /***** Node class *****/
+    class Node;
+    typedef std::shared_ptr<const Node> NodePointer;
+
+    class Node
+    {
+    public:
+        DataType data;
+        NodePointer left,
+                    right;
+        int height;         // levels in the subtree rooted here; leaves have 1
+
+        Node(const DataType& item, NodePointer leftChild, NodePointer rightChild)
+            : data(item), left(std::move(leftChild)), right(std::move(rightChild)),
+              height(1 + std::max(heightOf(left), heightOf(right)))
+        {}
+    };
+
+    /**
+     * Returns the height of a subtree; 0 for an empty one.
+     */
+    static int heightOf(const NodePointer& node);
+
+    /**
+     * Builds a node from item and two subtrees whose heights differ by at
+     * most two, rotating once or twice to restore the AVL rule.
+     */
+    static NodePointer balance(NodePointer left, const DataType& item, NodePointer right);
+
+    /**
+     * Returns subtree with item inserted; returns subtree itself, unchanged,
+     * if item is already present.
+     */
+    NodePointer insertAux(const NodePointer& subtree, const DataType& item, bool& inserted) const;
+
+    /**
+     * Returns subtree with item removed; returns subtree itself, unchanged,
+     * if item is not present.
+     */
+    NodePointer eraseAux(const NodePointer& subtree, const DataType& item, bool& erased) const;
+
+    /**
+     * Returns a non-empty subtree without its smallest item.
+     */
+    static NodePointer eraseMinAux(const NodePointer& subtree);
+
+    /**
+     * Prints the subtree rooted at node for graph, indented by indent
+     * columns.  The recursion is as deep as the tree is high.
+     */
+    static void graphAux(std::ostream& out, int indent, const Node* node);
+
+    /**
+     * Calls a visitor and reports whether to continue.
+     */
+    template <typename Visitor>
+    static bool visitItem(Visitor& visit, const DataType& item);
+
+    /***** Data Members *****/
+    NodePointer myRoot;
+    std::size_t mySize;
+    [[no_unique_address]] Compare myCompare;
+
+}; // end of class template declaration
+
+//--- Definition of constructor
+template <typename DataType, typename Compare>
+inline PersistentBST<DataType, Compare>::PersistentBST(const Compare& compare)
+    : myRoot(), mySize(0), myCompare(compare)
+{}
+
+//--- Definition of snapshot()
+template <typename DataType, typename Compare>
+inline PersistentBST<DataType, Compare> PersistentBST<DataType, Compare>::snapshot() const
+{
+    return *this;
+}
+
+//--- Definition of empty()
+template <typename DataType, typename Compare>
+inline bool PersistentBST<DataType, Compare>::empty() const
+{
+    return myRoot == nullptr;
+}
+
+//--- Definition of size()
+template <typename DataType, typename Compare>
+inline std::size_t PersistentBST<DataType, Compare>::size() const
+{
+    return mySize;
+}
+
+//--- Definition of search()
+template <typename DataType, typename Compare>
+bool PersistentBST<DataType, Compare>::search(const DataType& item) const
+{
+    const Node* node = myRoot.get();
+    while (node != nullptr)
+    {
+        if (myCompare(item, node->data))
+            node = node->left.get();
+        else if (myCompare(node->data, item))
+            node = node->right.get();
+        else
+            return true;
+    }
+    return false;
+}
+
+//--- Definition of insert()
+template <typename DataType, typename Compare>
+inline void PersistentBST<DataType, Compare>::insert(const DataType& item)
+{
+    if (!try_insert(item))
+        throw std::runtime_error("Item already in the tree");
+}
+
+//--- Definition of try_insert()
+template <typename DataType, typename Compare>
+bool PersistentBST<DataType, Compare>::try_insert(const DataType& item)
+{
+    bool inserted = false;
+    myRoot = insertAux(myRoot, item, inserted);
+    if (inserted)
+        ++mySize;
+    return inserted;
+}
+
+//--- Definition of remove()
+template <typename DataType, typename Compare>
+inline void PersistentBST<DataType, Compare>::remove(const DataType& item)
+{
+    if (!try_erase(item))
+        throw std::runtime_error("Item not in the BST");
+}
+
+//--- Definition of try_erase()
+template <typename DataType, typename Compare>
+bool PersistentBST<DataType, Compare>::try_erase(const DataType& item)
+{
+    bool erased = false;
+    myRoot = eraseAux(myRoot, item, erased);
+    if (erased)
+        --mySize;
+    return erased;
+}
+
+//--- Definition of clear()
+template <typename DataType, typename Compare>
+inline void PersistentBST<DataType, Compare>::clear()
+{
+    myRoot.reset();
+    mySize = 0;
+}
+
+//--- Definition of inorder()
+template <typename DataType, typename Compare>
+inline void PersistentBST<DataType, Compare>::inorder(std::ostream& out, std::string_view separator) const
+{
+    for_each_inorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of preorder()
+template <typename DataType, typename Compare>
+inline void PersistentBST<DataType, Compare>::preorder(std::ostream& out, std::string_view separator) const
+{
+    for_each_preorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of postorder()
+template <typename DataType, typename Compare>
+inline void PersistentBST<DataType, Compare>::postorder(std::ostream& out, std::string_view separator) const
+{
+    for_each_postorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of levelorder()
+template <typename DataType, typename Compare>
+inline void PersistentBST<DataType, Compare>::levelorder(std::ostream& out, std::string_view separator) const
+{
+    for_each_levelorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of for_each_inorder()
+template <typename DataType, typename Compare>
+template <typename Visitor>
+bool PersistentBST<DataType, Compare>::for_each_inorder(Visitor&& visit) const
+{
+    // This version holds the root, so plain pointers stay valid throughout
+    std::vector<const Node*> pending;
+    const Node* node = myRoot.get();
+    while (node != nullptr || !pending.empty())
+    {
+        for (; node != nullptr; node = node->left.get())
+            pending.push_back(node);
+        node = pending.back();
+        pending.pop_back();
+        if (!visitItem(visit, node->data))
+            return false;
+        node = node->right.get();
+    }
+    return true;
+}
+
+//--- Definition of for_each_preorder()
+template <typename DataType, typename Compare>
+template <typename Visitor>
+bool PersistentBST<DataType, Compare>::for_each_preorder(Visitor&& visit) const
+{
+    if (myRoot == nullptr)
+        return true;
+    std::vector<const Node*> pending{myRoot.get()};
+    while (!pending.empty())
+    {
+        const Node* node = pending.back();
+        pending.pop_back();
+        if (!visitItem(visit, node->data))
+            return false;
+        if (node->right != nullptr)
+            pending.push_back(node->right.get());
+        if (node->left != nullptr)
+            pending.push_back(node->left.get());
+    }
+    return true;
+}
+
+//--- Definition of for_each_postorder()
+template <typename DataType, typename Compare>
+template <typename Visitor>
+bool PersistentBST<DataType, Compare>::for_each_postorder(Visitor&& visit) const
+{
+    // A node is visited once its right subtree, if any, was the last one done
+    std::vector<const Node*> pending;
+    const Node* node = myRoot.get();
+    const Node* last = nullptr;
+    while (node != nullptr || !pending.empty())
+    {
+        for (; node != nullptr; node = node->left.get())
+            pending.push_back(node);
+        const Node* top = pending.back();
+        if (top->right != nullptr && top->right.get() != last)
+            node = top->right.get();
+        else
+        {
+            pending.pop_back();
+            if (!visitItem(visit, top->data))
+                return false;
+            last = top;
+        }
+    }
+    return true;
+}
+
+//--- Definition of for_each_levelorder()
+template <typename DataType, typename Compare>
+template <typename Visitor>
+bool PersistentBST<DataType, Compare>::for_each_levelorder(Visitor&& visit) const
+{
+    if (myRoot == nullptr)
+        return true;
+    std::vector<const Node*> level{myRoot.get()},
+                             next;
+    while (!level.empty())
+    {
+        for (const Node* node : level)
+        {
+            if (!visitItem(visit, node->data))
+                return false;
+            if (node->left != nullptr)
+                next.push_back(node->left.get());
+            if (node->right != nullptr)
+                next.push_back(node->right.get());
+        }
+        level.swap(next);
+        next.clear();
+    }
+    return true;
+}
+
+//--- Definition of graph()
+template <typename DataType, typename Compare>
+inline void PersistentBST<DataType, Compare>::graph(std::ostream& out) const
+{
+    graphAux(out, 0, myRoot.get());
+    out.flush();
+}
+
+//--- Definition of lower_bound()
+template <typename DataType, typename Compare>
+const DataType* PersistentBST<DataType, Compare>::lower_bound(const DataType& item) const
+{
+    const DataType* found = nullptr;
+    const Node* node = myRoot.get();
+    while (node != nullptr)
+    {
+        if (myCompare(node->data, item))
+            node = node->right.get();
+        else
+        {
+            found = &node->data;
+            node = node->left.get();
+        }
+    }
+    return found;
+}
+
+//--- Definition of range()
+template <typename DataType, typename Compare>
+template <typename Visitor>
+bool PersistentBST<DataType, Compare>::range(const DataType& low, const DataType& high, Visitor&& visit) const
+{
+    // Stack the path to low: every node on it >= low is still to be visited
+    std::vector<const Node*> pending;
+    const Node* node = myRoot.get();
+    while (node != nullptr)
+    {
+        if (myCompare(node->data, low))
+            node = node->right.get();
+        else
+        {
+            pending.push_back(node);
+            node = node->left.get();
+        }
+    }
+    while (!pending.empty())
+    {
+        node = pending.back();
+        pending.pop_back();
+        if (!myCompare(node->data, high))
+            break;
+        if (!visitItem(visit, node->data))
+            return false;
+        for (node = node->right.get(); node != nullptr; node = node->left.get())
+            pending.push_back(node);
+    }
+    return true;
+}
+
+//--- Definition of heightOf()
+template <typename DataType, typename Compare>
+inline int PersistentBST<DataType, Compare>::heightOf(const NodePointer& node)
+{
+    return node == nullptr ? 0 : node->height;
+}
+
+//--- Definition of balance()
+template <typename DataType, typename Compare>
+typename PersistentBST<DataType, Compare>::NodePointer
+PersistentBST<DataType, Compare>::balance(NodePointer left, const DataType& item, NodePointer right)
+{
+    int leftHeight = heightOf(left),
+        rightHeight = heightOf(right);
+    if (leftHeight > rightHeight + 1)
+    {
+        const Node& l = *left;
+        if (heightOf(l.left) >= heightOf(l.right))      // single right rotation
+            return std::make_shared<const Node>(l.data, l.left,
+                                                std::make_shared<const Node>(item, l.right, std::move(right)));
+        const Node& lr = *l.right;                      // left-right double rotation
+        return std::make_shared<const Node>(lr.data,
+                                            std::make_shared<const Node>(l.data, l.left, lr.left),
+                                            std::make_shared<const Node>(item, lr.right, std::move(right)));
+    }
+    if (rightHeight > leftHeight + 1)
+    {
+        const Node& r = *right;
+        if (heightOf(r.right) >= heightOf(r.left))      // single left rotation
+            return std::make_shared<const Node>(r.data,
+                                                std::make_shared<const Node>(item, std::move(left), r.left),
+                                                r.right);
+        const Node& rl = *r.left;                       // right-left double rotation
+        return std::make_shared<const Node>(rl.data,
+                                            std::make_shared<const Node>(item, std::move(left), rl.left),
+                                            std::make_shared<const Node>(r.data, rl.right, r.right));
+    }
+    return std::make_shared<const Node>(item, std::move(left), std::move(right));
+}
+
+//--- Definition of insertAux()
+template <typename DataType, typename Compare>
+typename PersistentBST<DataType, Compare>::NodePointer
+PersistentBST<DataType, Compare>::insertAux(const NodePointer& subtree, const DataType& item, bool& inserted) const
+{
+    if (subtree == nullptr)
+    {
+        inserted = true;
+        return std::make_shared<const Node>(item, nullptr, nullptr);
+    }
+    const Node& node = *subtree;
+    if (myCompare(item, node.data))
+    {
+        NodePointer left = insertAux(node.left, item, inserted);
+        return inserted ? balance(std::move(left), node.data, node.right) : subtree;
+    }
+    if (myCompare(node.data, item))
+    {
+        NodePointer right = insertAux(node.right, item, inserted);
+        return inserted ? balance(node.left, node.data, std::move(right)) : subtree;
+    }
+    return subtree;                     // already present -- share as is
+}
+
+//--- Definition of eraseAux()
+template <typename DataType, typename Compare>
+typename PersistentBST<DataType, Compare>::NodePointer
+PersistentBST<DataType, Compare>::eraseAux(const NodePointer& subtree, const DataType& item, bool& erased) const
+{
+    if (subtree == nullptr)
+        return subtree;
+    const Node& node = *subtree;
+    if (myCompare(item, node.data))
+    {
+        NodePointer left = eraseAux(node.left, item, erased);
+        return erased ? balance(std::move(left), node.data, node.right) : subtree;
+    }
+    if (myCompare(node.data, item))
+    {
+        NodePointer right = eraseAux(node.right, item, erased);
+        return erased ? balance(node.left, node.data, std::move(right)) : subtree;
+    }
+    erased = true;
+    if (node.left == nullptr)
+        return node.right;
+    if (node.right == nullptr)
+        return node.left;
+    // Two children: the inorder successor takes the node's place
+    const Node* successor = node.right.get();
+    while (successor->left != nullptr)
+        successor = successor->left.get();
+    return balance(node.left, successor->data, eraseMinAux(node.right));
+}
+
+//--- Definition of eraseMinAux()
+template <typename DataType, typename Compare>
+typename PersistentBST<DataType, Compare>::NodePointer
+PersistentBST<DataType, Compare>::eraseMinAux(const NodePointer& subtree)
+{
+    if (subtree->left == nullptr)
+        return subtree->right;
+    return balance(eraseMinAux(subtree->left), subtree->data, subtree->right);
+}
+
+//--- Definition of graphAux()
+template <typename DataType, typename Compare>
+void PersistentBST<DataType, Compare>::graphAux(std::ostream& out, int indent, const Node* node)
+{
+    if (node != nullptr)
+    {
+        graphAux(out, indent + 8, node->right.get());
+        out << std::setw(indent) << " " << node->data << '\n';
+        graphAux(out, indent + 8, node->left.get());
+    }
+    else
+        out << std::setw(indent) << " " << "_" << '\n';
+}
+
+//--- Definition of visitItem()
+template <typename DataType, typename Compare>
+template <typename Visitor>
+inline bool PersistentBST<DataType, Compare>::visitItem(Visitor& visit, const DataType& item)
+{
+    if constexpr (std::is_same_v<std::invoke_result_t<Visitor&, const DataType&>, bool>)
+        return visit(item);
+    else
+    {
+        visit(item);
+        return true;
+    }
+}
+
+#endif  // PERSISTENTBST_H_
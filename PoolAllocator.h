@@ -0,0 +1,358 @@
+/**
+ * @file PoolAllocator.h
+ * @brief Declaration of class template PoolAllocator.
+ *
+ * This file contains a slab/pool allocator intended for node-based containers
+ * such as BST.  Single-object requests are carved out of large chunks and
+ * recycled through a per-size free list, so steady insert/remove churn never
+ * reaches malloc.  Requests for more than one object fall through to
+ * operator new.
+ *
+ * Basic operations include:
+ * - allocate / deallocate: Standard allocator interface
+ * - reserve: Make room for a number of single-object allocations up front
+ * - release: Free all chunks of a resource at once, without per-object
+ *   deallocation
+ *
+ * A PoolAllocator creates its PoolResource on its first allocation, so an
+ * empty container costs no heap allocation.  From then on all copies and
+ * rebinds of it share that resource, so they compare equal and may free each
+ * other's memory.  A PoolResource is not thread-safe; containers sharing one
+ * must not be modified concurrently.
+ */
+
+#ifndef POOLALLOCATOR_H_
+#define POOLALLOCATOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class PoolResource
+ * @brief Chunked storage for fixed-size objects with free-list recycling.
+ *
+ * One size class is kept per distinct (size, alignment) pair requested.
+ * Chunks start small and double up to maxChunkObjects, and are only returned
+ * to the system when the resource is destroyed.
+ */
+class PoolResource
+{
+private:
+    /***** Free list link stored in unused slots *****/
+    struct FreeSlot
+    {
+        FreeSlot* next;
+    };
+
+    /***** Storage for one object size *****/
+    class SizeClass
+    {
+    public:
+        std::size_t size;
+        std::size_t align;
+        std::size_t slotSize;
+        std::size_t nextChunkObjects;
+        FreeSlot* freeList;
+        std::size_t freeCount;   // slots on freeList
+        char* cursor;      // next never-used slot in the newest chunk
+        char* end;         // end of the newest chunk
+        std::vector<void*> chunks;
+
+        SizeClass(std::size_t objectSize, std::size_t objectAlign)
+            : size(objectSize),
+              align(std::max(objectAlign, alignof(FreeSlot))),
+              slotSize(0), nextChunkObjects(16), freeList(nullptr), freeCount(0),
+              cursor(nullptr), end(nullptr)
+        {
+            std::size_t bytes = std::max(objectSize, sizeof(FreeSlot));
+            slotSize = (bytes + align - 1) / align * align;
+        }
+    };
+
+public:
+    /**
+     * @brief Constructs an empty resource.
+     *
+     * @param maxChunkObjects Upper bound on the number of objects per chunk.
+     */
+    explicit PoolResource(std::size_t maxChunkObjects = 4096)
+        : myMaxChunkObjects(std::max<std::size_t>(maxChunkObjects, 1))
+    {}
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    /**
+     * @brief Returns every chunk to the system.
+     */
+    ~PoolResource()
+    {
+        for (SizeClass& sc : mySizeClasses)
+            for (void* chunk : sc.chunks)
+                ::operator delete(chunk, std::align_val_t(sc.align));
+    }
+
+    /**
+     * @brief Allocates storage for one object.
+     *
+     * @param size Size of the object in bytes.
+     * @param align Alignment of the object.
+     * @return Pointer to uninitialized storage.
+     * @throws std::bad_alloc if a new chunk cannot be obtained.
+     */
+    void* allocate(std::size_t size, std::size_t align)
+    {
+        SizeClass& sc = sizeClass(size, align);
+        if (sc.freeList != nullptr)
+        {
+            FreeSlot* slot = sc.freeList;
+            sc.freeList = slot->next;
+            --sc.freeCount;
+            return slot;
+        }
+        if (sc.cursor == sc.end)
+            grow(sc, sc.nextChunkObjects);
+        void* p = sc.cursor;
+        sc.cursor += sc.slotSize;
+        return p;
+    }
+
+    /**
+     * @brief Returns storage for one object to its free list.
+     *
+     * @param p Pointer previously returned by allocate with the same size.
+     * @param size Size of the object in bytes.
+     * @param align Alignment of the object.
+     */
+    void deallocate(void* p, std::size_t size, std::size_t align)
+    {
+        SizeClass& sc = sizeClass(size, align);
+        FreeSlot* slot = ::new (p) FreeSlot;
+        slot->next = sc.freeList;
+        sc.freeList = slot;
+        ++sc.freeCount;
+    }
+
+    /**
+     * @brief Ensures that count further allocations need at most one new chunk.
+     *
+     * Slots on the free list count towards count, so no chunk is added if
+     * earlier deallocations left enough of them.
+     *
+     * @param count Number of objects about to be allocated.
+     * @param size Size of the object in bytes.
+     * @param align Alignment of the object.
+     */
+    void reserve(std::size_t count, std::size_t size, std::size_t align)
+    {
+        SizeClass& sc = sizeClass(size, align);
+        std::size_t available = sc.freeCount + static_cast<std::size_t>(sc.end - sc.cursor) / sc.slotSize;
+        if (available < count)
+            grow(sc, count - available);
+    }
+
+    /**
+     * @brief Returns every chunk to the system at once.
+     *
+     * Every object allocated from the resource must already be destroyed;
+     * their storage is reclaimed without individual deallocate calls.  The
+     * resource stays usable.
+     */
+    void release()
+    {
+        for (SizeClass& sc : mySizeClasses)
+        {
+            for (void* chunk : sc.chunks)
+                ::operator delete(chunk, std::align_val_t(sc.align));
+            sc.chunks.clear();
+            sc.freeList = nullptr;
+            sc.freeCount = 0;
+            sc.cursor = nullptr;
+            sc.end = nullptr;
+        }
+    }
+
+private:
+    /**
+     * Finds (or creates) the size class serving objects of the given shape.
+     */
+    SizeClass& sizeClass(std::size_t size, std::size_t align)
+    {
+        align = std::max(align, alignof(FreeSlot));
+        if (myLast != nullptr && myLast->size == size && myLast->align == align)
+            return *myLast;
+        for (SizeClass& sc : mySizeClasses)
+        {
+            if (sc.size == size && sc.align == align)
+            {
+                myLast = &sc;
+                return sc;
+            }
+        }
+        mySizeClasses.emplace_back(size, align);
+        // emplace_back may have moved the other size classes
+        myLast = &mySizeClasses.back();
+        return *myLast;
+    }
+
+    /**
+     * Starts a new chunk holding at least minObjects slots.  Unused slots of
+     * the previous chunk are threaded onto the free list first.
+     */
+    void grow(SizeClass& sc, std::size_t minObjects)
+    {
+        for (; sc.cursor != sc.end; sc.cursor += sc.slotSize)
+        {
+            FreeSlot* slot = ::new (sc.cursor) FreeSlot;
+            slot->next = sc.freeList;
+            sc.freeList = slot;
+            ++sc.freeCount;
+        }
+        std::size_t objects = std::max(minObjects, sc.nextChunkObjects);
+        sc.chunks.reserve(sc.chunks.size() + 1);
+        char* chunk = static_cast<char*>(
+            ::operator new(objects * sc.slotSize, std::align_val_t(sc.align)));
+        sc.chunks.push_back(chunk);
+        sc.cursor = chunk;
+        sc.end = chunk + objects * sc.slotSize;
+        sc.nextChunkObjects = std::min(sc.nextChunkObjects * 2, myMaxChunkObjects);
+    }
+
+    /***** Data Members *****/
+    std::size_t myMaxChunkObjects;
+    std::vector<SizeClass> mySizeClasses;
+    SizeClass* myLast = nullptr;
+};
+
+/**
+ * @class PoolAllocator
+ * @brief Standard allocator backed by a shared PoolResource.
+ *
+ * A default-constructed PoolAllocator gets a fresh resource when it first
+ * allocates.  Copying a container selects a fresh allocator as well, while
+ * moving or swapping carries the resource along with the elements; a
+ * moved-from allocator is left without a resource, so the container it
+ * was moved out of gets a fresh pool if it is used again.  Two
+ * allocators that have not allocated yet compare equal, since neither has
+ * memory the other could be asked to free.
+ */
+template <typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    /**
+     * @brief Constructs an allocator that will create its own resource on
+     *        its first allocation.
+     *
+     * @param maxChunkObjects Upper bound on the number of objects per chunk.
+     */
+    explicit PoolAllocator(std::size_t maxChunkObjects = 4096) noexcept
+        : myResource(), myMaxChunkObjects(maxChunkObjects)
+    {}
+
+    // Copies share the resource.  A move takes it, leaving the source like a
+    // new allocator, so a moved-from container is usable and independent.
+    PoolAllocator(const PoolAllocator&) noexcept = default;
+    PoolAllocator(PoolAllocator&&) noexcept = default;
+    PoolAllocator& operator=(const PoolAllocator&) noexcept = default;
+    PoolAllocator& operator=(PoolAllocator&&) noexcept = default;
+
+    /**
+     * @brief Rebinding constructor -- shares the resource of other.
+     */
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept
+        : myResource(other.myResource), myMaxChunkObjects(other.myMaxChunkObjects)
+    {}
+
+    /**
+     * @brief Allocates storage for n objects of type T.
+     *
+     * @param n Number of objects.
+     * @return Pointer to uninitialized storage.
+     */
+    T* allocate(std::size_t n)
+    {
+        if (n == 1)
+            return static_cast<T*>(pool().allocate(sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    /**
+     * @brief Releases storage obtained from allocate.
+     *
+     * @param p Pointer returned by allocate.
+     * @param n Number of objects passed to allocate.
+     */
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        if (n == 1)
+            myResource->deallocate(p, sizeof(T), alignof(T));
+        else
+            ::operator delete(p, std::align_val_t(alignof(T)));
+    }
+
+    /**
+     * @brief Prepares for n single-object allocations from one chunk.
+     *
+     * @param n Number of objects about to be allocated.
+     */
+    void reserve(std::size_t n)
+    {
+        pool().reserve(n, sizeof(T), alignof(T));
+    }
+
+    /**
+     * @brief A copied container gets its own resource.
+     */
+    PoolAllocator select_on_container_copy_construction() const
+    {
+        return PoolAllocator(myMaxChunkObjects);
+    }
+
+    /**
+     * @brief Returns the shared resource backing this allocator, or null if
+     *        it has not allocated yet.
+     */
+    const std::shared_ptr<PoolResource>& resource() const noexcept
+    {
+        return myResource;
+    }
+
+private:
+    template <typename U>
+    friend class PoolAllocator;
+
+    /**
+     * Returns the resource, creating it on first use.
+     */
+    PoolResource& pool()
+    {
+        if (myResource == nullptr)
+            myResource = std::make_shared<PoolResource>(myMaxChunkObjects);
+        return *myResource;
+    }
+
+    /***** Data Members *****/
+    std::shared_ptr<PoolResource> myResource;   // null until the first allocation
+    std::size_t myMaxChunkObjects;
+};
+
+//--- Definition of operator==()
+template <typename T, typename U>
+inline bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept
+{
+    return a.resource() == b.resource();
+}
+
+#endif  // POOLALLOCATOR_H_
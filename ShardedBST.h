@@ -0,0 +1,483 @@
+/**
+ * @file ShardedBST.h
+ * @brief Declaration of class template ShardedBST.
+ *
+ * This file contains a thread-safe set that spreads its items over N
+ * independent BSTs (shards), each with its own reader-writer lock and its
+ * own allocator.  Updates to different shards never contend, so write
+ * throughput grows with the number of shards instead of serializing on
+ * one root.
+ *
+ * Items are routed to a shard in one of two ways:
+ * - by key range: N - 1 increasing splitters divide the items into N
+ *   consecutive runs, shard i holding those not less than splitter i - 1
+ *   and less than splitter i
+ * - by hash: for point lookups and updates only, where hashing spreads
+ *   skewed keys more evenly than fixed splitters
+ *
+ * Basic operations include:
+ * - search, insert, try_insert, remove, try_erase: Point operations
+ *   locking only the item's shard
+ * - size, empty, lower_bound, clear: Operations visiting the shards one at
+ *   a time
+ * - inorder, for_each_inorder, range: Ordered traversals over one
+ *   consistent state of all shards, merging the shards k ways
+ */
+
+#ifndef SHARDEDBST_H_
+#define SHARDEDBST_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BST.h"
+
+/**
+ * @class ShardedBST
+ * @brief A set partitioned over N independently locked BSTs.
+ *
+ * Every shard default-constructs its own Alloc, so with PoolAllocator each
+ * shard draws its nodes from a private pool that needs no locking.
+ * Visitors run while shard locks are held and must not call back into the
+ * same ShardedBST.
+ *
+ * @tparam DataType Type of the stored items.
+ * @tparam N Number of shards.
+ * @tparam Alloc, Balance, Compare As for BST.
+ * @tparam Hash Hash function used for hash routing.
+ */
+template <typename DataType,
+          std::size_t N,
+          typename Alloc = PoolAllocator<DataType>,
+          typename Balance = Unbalanced,
+          typename Compare = std::less<>,
+          typename Hash = std::hash<DataType>>
+class ShardedBST
+{
+    static_assert(N > 0, "ShardedBST needs at least one shard");
+
+public:
+    typedef BST<DataType, Alloc, Balance, Compare> tree_type;
+
+    /**
+     * @brief Constructs an empty set routing items by hash.
+     *
+     * @param compare Comparator ordering the items (optional).
+     * @param hash Hash function routing the items (optional).
+     */
+    explicit ShardedBST(const Compare& compare = Compare(), const Hash& hash = Hash());
+
+    /**
+     * @brief Constructs an empty set routing items by key range.
+     *
+     * @param splitters N - 1 strictly increasing items; items less than
+     *                  splitters[0] go to shard 0, and so on.
+     * @param compare Comparator ordering the items (optional).
+     * @throws std::runtime_error if the splitters are not N - 1 strictly
+     *         increasing items.
+     */
+    explicit ShardedBST(std::span<const DataType> splitters, const Compare& compare = Compare());
+
+    ShardedBST(const ShardedBST&) = delete;
+    ShardedBST& operator=(const ShardedBST&) = delete;
+
+    /**
+     * @brief Checks if every shard is empty.
+     */
+    bool empty() const;
+
+    /**
+     * @brief Returns the total number of items.
+     *
+     * The shards are counted one after the other, so the result may mix
+     * states if updates run concurrently.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Searches for a given item.
+     *
+     * @param item The item to search for.
+     * @return true if the item is found, false otherwise.
+     */
+    bool search(const DataType& item) const;
+
+    /**
+     * @brief Finds the first item not less than the given item.
+     *
+     * @param item The item to compare against.
+     * @return A copy of the first item >= item, or nothing if there is none.
+     */
+    std::optional<DataType> lower_bound(const DataType& item) const;
+
+    /**
+     * @brief Inserts an item.
+     *
+     * @param item The item to be inserted.
+     * @throws std::runtime_error if the item is already in the set.
+     */
+    void insert(const DataType& item);
+
+    /**
+     * @brief Inserts an item if no equal item is present.
+     *
+     * @param item The item to be inserted.
+     * @return true if the item was inserted, false if it was already present.
+     */
+    bool try_insert(const DataType& item);
+
+    /**
+     * @brief Removes an item.
+     *
+     * @param item The item to be removed.
+     * @throws std::runtime_error if the item is not in the set.
+     */
+    void remove(const DataType& item);
+
+    /**
+     * @brief Removes an item if present.
+     *
+     * @param item The item to be removed.
+     * @return true if the item was removed, false if it was not in the set.
+     */
+    bool try_erase(const DataType& item);
+
+    /**
+     * @brief Removes all items, one shard at a time.
+     */
+    void clear();
+
+    /**
+     * @brief Outputs the items in order to the specified output stream.
+     *
+     * @param out The output stream to which the elements will be written.
+     * @param separator String to separate elements (optional).
+     */
+    void inorder(std::ostream& out, std::string_view separator = "  ") const;
+
+    /**
+     * @brief Calls visit on every item in order, holding all shards in
+     *        shared mode.
+     *
+     * @param visit Callable invoked as visit(item); a visitor returning
+     *              bool stops early by returning false.
+     * @return false if visit stopped early, true otherwise.
+     */
+    template <typename Visitor>
+    bool for_each_inorder(Visitor&& visit) const;
+
+    /**
+     * @brief Visits, in order, every item in [low, high), holding all
+     *        shards in shared mode.
+     *
+     * @param low Smallest item to visit.
+     * @param high Items not less than high are not visited.
+     * @param visit Callable invoked as visit(item) for each item in range;
+     *              a visitor returning bool stops early by returning false.
+     * @return false if visit stopped early, true otherwise.
+     */
+    template <typename Visitor>
+    bool range(const DataType& low, const DataType& high, Visitor&& visit) const;
+
+private:
+    /***** One shard, on its own cache lines *****/
+    struct alignas(64) Shard
+    {
+        mutable std::shared_mutex mutex;
+        tree_type tree;
+
+        explicit Shard(const Compare& compare)
+            : tree(compare)
+        {}
+    };
+
+    /**
+     * Returns N shards ordered by compare, one per index.  Each is
+     * constructed in place in the returned array, as shards cannot be
+     * moved.
+     */
+    template <std::size_t... Index>
+    static std::array<Shard, N> makeShards(const Compare& compare, std::index_sequence<Index...>);
+
+    /**
+     * Returns the index of the shard item belongs to.
+     */
+    std::size_t route(const DataType& item) const;
+
+    /**
+     * Visits the items in [*low, *high) in order under shared locks on all
+     * shards; a null bound is unbounded.
+     */
+    template <typename Visitor>
+    bool mergeAux(const DataType* low, const DataType* high, Visitor& visit) const;
+
+    /**
+     * Calls a visitor and reports whether to continue.
+     */
+    template <typename Visitor>
+    static bool visitItem(Visitor& visit, const DataType& item);
+
+    /***** Data Members *****/
+    std::array<Shard, N> myShards;
+    std::vector<DataType> mySplitters;   // empty when routing by hash
+    [[no_unique_address]] Compare myCompare;
+    [[no_unique_address]] Hash myHash;
+
+}; // end of class template declaration
+
+//--- Definition of hash-routing constructor
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::ShardedBST(const Compare& compare, const Hash& hash)
+    : myShards(makeShards(compare, std::make_index_sequence<N>())), myCompare(compare), myHash(hash)
+{}
+
+//--- Definition of range-routing constructor
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::ShardedBST(std::span<const DataType> splitters,
+                                                                   const Compare& compare)
+    : myShards(makeShards(compare, std::make_index_sequence<N>())),
+      mySplitters(splitters.begin(), splitters.end()), myCompare(compare), myHash()
+{
+    if (splitters.size() != N - 1)
+        throw std::runtime_error("Expected one splitter fewer than shards");
+    if (std::adjacent_find(splitters.begin(), splitters.end(),
+                           [&](const DataType& a, const DataType& b) { return !myCompare(a, b); })
+        != splitters.end())
+        throw std::runtime_error("Splitters are not strictly increasing");
+}
+
+//--- Definition of empty()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+bool ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::empty() const
+{
+    for (const Shard& shard : myShards)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        if (!shard.tree.empty())
+            return false;
+    }
+    return true;
+}
+
+//--- Definition of size()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+std::size_t ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::size() const
+{
+    std::size_t count = 0;
+    for (const Shard& shard : myShards)
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        count += shard.tree.size();
+    }
+    return count;
+}
+
+//--- Definition of search()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+inline bool ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::search(const DataType& item) const
+{
+    const Shard& shard = myShards[route(item)];
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.tree.search(item);
+}
+
+//--- Definition of lower_bound()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+std::optional<DataType> ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::lower_bound(const DataType& item) const
+{
+    std::optional<DataType> best;
+    // By range, the first shard from item's own with a candidate has the
+    // answer; by hash, every shard may hold it.
+    std::size_t first = mySplitters.empty() ? 0 : route(item);
+    for (std::size_t i = first; i < N; ++i)
+    {
+        std::shared_lock<std::shared_mutex> lock(myShards[i].mutex);
+        auto found = myShards[i].tree.lower_bound(item);
+        if (found == myShards[i].tree.end())
+            continue;
+        if (!best || myCompare(*found, *best))
+            best = *found;
+        if (!mySplitters.empty())
+            break;
+    }
+    return best;
+}
+
+//--- Definition of insert()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+inline void ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::insert(const DataType& item)
+{
+    if (!try_insert(item))
+        throw std::runtime_error("Item already in the tree");
+}
+
+//--- Definition of try_insert()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+inline bool ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::try_insert(const DataType& item)
+{
+    Shard& shard = myShards[route(item)];
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.tree.try_insert(item).second;
+}
+
+//--- Definition of remove()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+inline void ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::remove(const DataType& item)
+{
+    if (!try_erase(item))
+        throw std::runtime_error("Item not in the BST");
+}
+
+//--- Definition of try_erase()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+inline bool ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::try_erase(const DataType& item)
+{
+    Shard& shard = myShards[route(item)];
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.tree.try_erase(item);
+}
+
+//--- Definition of clear()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+void ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::clear()
+{
+    for (Shard& shard : myShards)
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.tree.clear();
+    }
+}
+
+//--- Definition of inorder()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+void ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::inorder(std::ostream& out,
+                                                                     std::string_view separator) const
+{
+    for_each_inorder([&](const DataType& item) { out << item << separator; });
+}
+
+//--- Definition of for_each_inorder()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+template <typename Visitor>
+inline bool ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::for_each_inorder(Visitor&& visit) const
+{
+    return mergeAux(nullptr, nullptr, visit);
+}
+
+//--- Definition of range()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+template <typename Visitor>
+inline bool ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::range(const DataType& low,
+                                                                          const DataType& high,
+                                                                          Visitor&& visit) const
+{
+    return mergeAux(&low, &high, visit);
+}
+
+//--- Definition of makeShards()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+template <std::size_t... Index>
+std::array<typename ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::Shard, N>
+ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::makeShards(const Compare& compare, std::index_sequence<Index...>)
+{
+    return {{(static_cast<void>(Index), Shard(compare))...}};
+}
+
+//--- Definition of route()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+inline std::size_t ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::route(const DataType& item) const
+{
+    if (mySplitters.empty())
+        return N == 1 ? 0 : myHash(item) % N;
+    return static_cast<std::size_t>(std::upper_bound(mySplitters.begin(), mySplitters.end(), item, myCompare)
+                                    - mySplitters.begin());
+}
+
+//--- Definition of mergeAux()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+template <typename Visitor>
+bool ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::mergeAux(const DataType* low, const DataType* high,
+                                                                      Visitor& visit) const
+{
+    // Writers lock a single shard, so taking all of them in index order
+    // cannot deadlock
+    std::array<std::shared_lock<std::shared_mutex>, N> locks;
+    for (std::size_t i = 0; i < N; ++i)
+        locks[i] = std::shared_lock<std::shared_mutex>(myShards[i].mutex);
+
+    typedef typename tree_type::const_iterator Iterator;
+    auto start = [low](const tree_type& tree) { return low ? tree.lower_bound(*low) : tree.begin(); };
+    auto belowHigh = [&](const DataType& item) { return !high || myCompare(item, *high); };
+
+    if (!mySplitters.empty())
+    {                                   // the shards hold consecutive runs
+        for (std::size_t i = low ? route(*low) : 0; i < N; ++i)
+        {
+            const tree_type& tree = myShards[i].tree;
+            for (Iterator it = start(tree); it != tree.end(); ++it)
+            {
+                if (!belowHigh(*it))
+                    return true;
+                if (!visitItem(visit, *it))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Hashed shards interleave: repeatedly take the smallest head from a
+    // min-heap of the shards' cursors
+    std::array<Iterator, N> next;
+    std::vector<std::size_t> heap;
+    heap.reserve(N);
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        next[i] = start(myShards[i].tree);
+        if (next[i] != myShards[i].tree.end())
+            heap.push_back(i);
+    }
+    auto later = [&](std::size_t a, std::size_t b) { return myCompare(*next[b], *next[a]); };
+    std::make_heap(heap.begin(), heap.end(), later);
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        std::size_t i = heap.back();
+        if (!belowHigh(*next[i]))
+            return true;
+        if (!visitItem(visit, *next[i]))
+            return false;
+        if (++next[i] != myShards[i].tree.end())
+            std::push_heap(heap.begin(), heap.end(), later);
+        else
+            heap.pop_back();
+    }
+    return true;
+}
+
+//--- Definition of visitItem()
+template <typename DataType, std::size_t N, typename Alloc, typename Balance, typename Compare, typename Hash>
+template <typename Visitor>
+inline bool ShardedBST<DataType, N, Alloc, Balance, Compare, Hash>::visitItem(Visitor& visit, const DataType& item)
+{
+    if constexpr (std::is_same_v<std::invoke_result_t<Visitor&, const DataType&>, bool>)
+        return visit(item);
+    else
+    {
+        visit(item);
+        return true;
+    }
+}
+
+#endif  // SHARDEDBST_H_
@@ -0,0 +1,286 @@
+/**
+ * @file ThreadPool.h
+ * @brief Declaration of class ThreadPool.
+ *
+ * This file contains a small work-stealing thread pool for fork-join
+ * parallelism, used by BST::build_parallel and BST::clear_parallel.  Each
+ * worker keeps its own deque of pending jobs: it pushes and pops at the
+ * back, which keeps a recursive computation depth-first and cache-warm,
+ * while idle workers steal from the front of other deques, where the
+ * oldest -- and, in a divide-and-conquer computation, largest -- jobs are.
+ *
+ * Basic operations include:
+ * - instance: The process-wide pool, with one worker per hardware thread
+ * - parallel_invoke: Runs two callables, possibly in parallel, and waits
+ *   for both
+ * - size: Number of worker threads
+ *
+ * A thread waiting for a stolen job runs other pending jobs meanwhile, so
+ * nested parallel_invoke calls never leave a worker blocked.
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads with per-worker work-stealing deques.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param threads Number of workers (optional; at least one).
+     */
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency())
+    {
+        threads = std::max(threads, 1u);
+        // One deque per worker, plus one shared by threads outside the pool
+        for (unsigned i = 0; i <= threads; ++i)
+            myQueues.push_back(std::make_unique<Queue>());
+        myThreads.reserve(threads);
+        for (unsigned i = 0; i < threads; ++i)
+            myThreads.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Stops the workers once no jobs are pending.
+     */
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mySleepMutex);
+            myStopping = true;
+        }
+        myWake.notify_all();
+        for (std::thread& thread : myThreads)
+            thread.join();
+    }
+
+    /**
+     * @brief Returns the process-wide pool.
+     */
+    static ThreadPool& instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Returns the number of worker threads.
+     */
+    std::size_t size() const
+    {
+        return myQueues.size() - 1;
+    }
+
+    /**
+     * @brief Runs first() and second(), possibly in parallel, and returns
+     *        when both have finished.
+     *
+     * first runs on the calling thread; second is offered to the other
+     * workers and run by the caller itself if nobody has taken it by then.
+     * If either throws, the exception is rethrown once both have finished
+     * (the one from first if both throw).
+     */
+    template <typename F, typename G>
+    void parallel_invoke(F&& first, G&& second)
+    {
+        JobFor<std::remove_reference_t<G>> job(second);
+        push(&job);
+
+        std::exception_ptr error;
+        try
+        {
+            first();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        if (take(&job))
+            job.run(&job);
+        else
+        {                               // stolen -- help out until it is done
+            while (!job.done.load(std::memory_order_acquire))
+            {
+                if (!runOne())
+                    std::this_thread::yield();
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+        if (job.error)
+            std::rethrow_exception(job.error);
+    }
+
+private:
+    /***** A pending call, owned by the thread waiting for it *****/
+    struct Job
+    {
+        void (*run)(Job*);
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+    };
+
+    template <typename F>
+    struct JobFor : Job
+    {
+        F& function;
+
+        explicit JobFor(F& f)
+            : function(f)
+        {
+            this->run = [](Job* job)
+            {
+                try
+                {
+                    static_cast<JobFor*>(job)->function();
+                }
+                catch (...)
+                {
+                    job->error = std::current_exception();
+                }
+                // The owner may destroy the job as soon as it sees done
+                job->done.store(true, std::memory_order_release);
+            };
+        }
+    };
+
+    /***** One worker's deque *****/
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Job*> jobs;
+    };
+
+    /***** Identifies the pool and deque of the calling worker thread *****/
+    struct WorkerId
+    {
+        const ThreadPool* pool = nullptr;
+        std::size_t index = 0;
+    };
+
+    static WorkerId& currentWorker()
+    {
+        thread_local WorkerId id;
+        return id;
+    }
+
+    /**
+     * Returns the deque of the calling thread: its own if it is one of the
+     * workers, the shared outside deque otherwise.
+     */
+    std::size_t ownQueue() const
+    {
+        const WorkerId& id = currentWorker();
+        // myQueues is complete before any worker starts; myThreads is not
+        return id.pool == this ? id.index : myQueues.size() - 1;
+    }
+
+    void push(Job* job)
+    {
+        Queue& queue = *myQueues[ownQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(job);
+        }
+        myQueued.fetch_add(1);
+        {                               // a worker about to sleep sees the count
+            std::lock_guard<std::mutex> lock(mySleepMutex);
+        }
+        myWake.notify_one();
+    }
+
+    /**
+     * Takes job back from the caller's deque unless it has been stolen.
+     */
+    bool take(Job* job)
+    {
+        Queue& queue = *myQueues[ownQueue()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty() || queue.jobs.back() != job)
+            return false;
+        queue.jobs.pop_back();
+        myQueued.fetch_sub(1);
+        return true;
+    }
+
+    /**
+     * Runs one pending job: the newest from the caller's deque, or else
+     * the oldest from another deque.
+     *
+     * @return false if no job was found.
+     */
+    bool runOne()
+    {
+        std::size_t own = ownQueue(),
+                    count = myQueues.size();
+        Job* job = nullptr;
+        for (std::size_t k = 0; k < count && job == nullptr; ++k)
+        {
+            Queue& queue = *myQueues[(own + k) % count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.jobs.empty())
+                continue;
+            if (k == 0)
+            {
+                job = queue.jobs.back();
+                queue.jobs.pop_back();
+            }
+            else
+            {
+                job = queue.jobs.front();
+                queue.jobs.pop_front();
+            }
+        }
+        if (job == nullptr)
+            return false;
+        myQueued.fetch_sub(1);
+        job->run(job);
+        return true;
+    }
+
+    void workerLoop(std::size_t index)
+    {
+        currentWorker() = WorkerId{this, index};
+        while (true)
+        {
+            if (runOne())
+                continue;
+            std::unique_lock<std::mutex> lock(mySleepMutex);
+            myWake.wait(lock, [this] { return myStopping || myQueued.load() > 0; });
+            if (myStopping && myQueued.load() == 0)
+                return;
+        }
+    }
+
+    /***** Data Members *****/
+    std::vector<std::unique_ptr<Queue>> myQueues;   // per worker, then the outside one
+    std::vector<std::thread> myThreads;
+    std::atomic<std::size_t> myQueued{0};           // jobs pushed but not yet taken
+    std::mutex mySleepMutex;
+    std::condition_variable myWake;
+    bool myStopping = false;
+};
+
+#endif  // THREADPOOL_H_
@@ -0,0 +1,90 @@
+/**
+ * @file concurrent_scaling.cpp
+ * @brief Benchmark: ConcurrentBST throughput from 1 to 64 threads.
+ *
+ * Prefills a red-black ConcurrentBST with every other key of a range, then
+ * splits a fixed number of random operations among 1, 2, 4, ... 64
+ * threads, at several percentages of writes.  A write is a try_insert or a
+ * try_erase with equal odds, so the size stays about the same; the rest
+ * are searches.  Reads share the lock and should scale with the cores;
+ * writes serialize.
+ *
+ * Usage: concurrent_scaling [size] [operations]   (default: 1000000 4000000)
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentBST.h"
+
+typedef ConcurrentBST<int, PoolAllocator<int>, RedBlack> Tree;
+
+// Runs operations random operations on tree split among threads threads;
+// returns the elapsed seconds
+double run(Tree& tree, int keys, std::size_t operations, unsigned threads, unsigned writePercent)
+{
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]
+        {
+            std::uint64_t state = 0x9E3779B97F4A7C15ull * (t + 1);
+            for (std::size_t i = t; i < operations; i += threads)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                int key = static_cast<int>(state % static_cast<std::uint64_t>(keys));
+                unsigned dice = static_cast<unsigned>((state >> 32) % 200);
+                if (dice < 2 * writePercent)
+                {
+                    if (dice % 2 == 0)
+                        tree.try_insert(key);
+                    else
+                        tree.try_erase(key);
+                }
+                else
+                    tree.search(key);
+            }
+        });
+    for (std::thread& worker : workers)
+        worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000,
+                operations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4000000;
+    int keys = static_cast<int>(2 * size);
+
+    std::printf("%zu items, %zu operations, %u hardware threads\n", size, operations,
+                std::thread::hardware_concurrency());
+    std::printf("threads");
+    for (unsigned writePercent : {0u, 10u, 50u})
+        std::printf("   %3u%% writes", writePercent);
+    std::printf("   (M ops/s)\n");
+
+    for (unsigned threads = 1; threads <= 64; threads *= 2)
+    {
+        std::printf("%7u", threads);
+        for (unsigned writePercent : {0u, 10u, 50u})
+        {
+            BST<int, PoolAllocator<int>, RedBlack> initial;
+            std::vector<int> items;
+            for (int key = 0; key < keys; key += 2)
+                items.push_back(key);
+            initial.build_sorted(items.begin(), items.end());
+            Tree tree(std::move(initial));
+            double seconds = run(tree, keys, operations, threads, writePercent);
+            std::printf("   %11.2f", operations / seconds / 1e6);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
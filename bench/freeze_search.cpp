@@ -0,0 +1,73 @@
+/**
+ * @file freeze_search.cpp
+ * @brief Benchmark: search in the pointer tree vs its FrozenBST snapshot.
+ *
+ * For each size, builds a balanced tree of the even numbers below 2n,
+ * freezes it, and times random lookups (about half of them hits) with
+ * BST::search and FrozenBST::search, and with both lower_bounds.
+ *
+ * Usage: freeze_search [size...]   (default: 1000 1000000; add 100000000
+ *        for the largest size, which needs several GB of memory)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "BST.h"
+
+template <typename Lookup>
+double nanosPerLookup(const std::vector<int>& keys, std::size_t& checksum, Lookup lookup)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int key : keys)
+        checksum += lookup(key);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return 1e9 * elapsed.count() / static_cast<double>(keys.size());
+}
+
+void run(std::size_t size, std::size_t lookups)
+{
+    std::vector<int> items(size);
+    for (std::size_t i = 0; i < size; ++i)
+        items[i] = static_cast<int>(2 * i);
+    BST<int> tree;
+    tree.build_sorted(items.begin(), items.end());
+    FrozenBST<int> frozen = tree.freeze();
+    items.clear();
+    items.shrink_to_fit();
+
+    std::mt19937 rng(7);
+    std::vector<int> keys(lookups);
+    for (int& key : keys)
+        key = static_cast<int>(rng() % (2 * size));
+
+    std::size_t checksum = 0;
+    double treeSearch = nanosPerLookup(keys, checksum, [&](int k) { return tree.search(k); }),
+           frozenSearch = nanosPerLookup(keys, checksum, [&](int k) { return frozen.search(k); }),
+           treeLower = nanosPerLookup(keys, checksum,
+                                      [&](int k) { return tree.lower_bound(k) != tree.end(); }),
+           frozenLower = nanosPerLookup(keys, checksum,
+                                        [&](int k) { return frozen.lower_bound(k) != nullptr; });
+    std::printf("%11zu keys  search %7.1f / %7.1f ns (%.2fx)  lower_bound %7.1f / %7.1f ns (%.2fx)  [%zu]\n",
+                size, treeSearch, frozenSearch, treeSearch / frozenSearch,
+                treeLower, frozenLower, treeLower / frozenLower, checksum);
+}
+
+int main(int argc, char* argv[])
+{
+    std::printf("times: BST / FrozenBST\n");
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+            run(std::strtoul(argv[i], nullptr, 10), 2000000);
+    }
+    else
+    {
+        run(1000, 2000000);
+        run(1000000, 2000000);
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file lockfree_vs_locked.cpp
+ * @brief Benchmark: LockFreeBST vs ConcurrentBST at 90% reads, 10% writes.
+ *
+ * Both trees start with every other key of a range, inserted in the same
+ * random order, so the lock-free tree (which is not balanced) has a
+ * reasonable shape and neither has its nodes laid out in order.  The
+ * ConcurrentBST is red-black.  A fixed number of random operations is then
+ * split among 1, 2, 4, ... 64 threads: 90% searches, and 10% try_insert or
+ * try_erase with equal odds.
+ *
+ * Usage: lockfree_vs_locked [size] [operations]   (default: 1000000 4000000)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentBST.h"
+#include "LockFreeBST.h"
+
+// Runs operations random operations on tree split among threads threads;
+// returns the elapsed seconds
+template <typename Tree>
+double run(Tree& tree, int keys, std::size_t operations, unsigned threads)
+{
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]
+        {
+            std::uint64_t state = 0x9E3779B97F4A7C15ull * (t + 1);
+            for (std::size_t i = t; i < operations; i += threads)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                int key = static_cast<int>(state % static_cast<std::uint64_t>(keys));
+                switch ((state >> 32) % 20)
+                {
+                case 0:
+                    tree.try_insert(key);
+                    break;
+                case 1:
+                    tree.try_erase(key);
+                    break;
+                default:
+                    tree.search(key);
+                }
+            }
+        });
+    for (std::thread& worker : workers)
+        worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000,
+                operations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4000000;
+    int keys = static_cast<int>(2 * size);
+
+    std::vector<int> shuffled;
+    for (int key = 0; key < keys; key += 2)
+        shuffled.push_back(key);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(3));
+
+    std::printf("%zu items, %zu operations, %u hardware threads\n", size, operations,
+                std::thread::hardware_concurrency());
+    std::printf("threads   LockFreeBST   ConcurrentBST   (M ops/s)\n");
+    for (unsigned threads = 1; threads <= 64; threads *= 2)
+    {
+        LockFreeBST<int> lockFree;
+        for (int item : shuffled)
+            lockFree.try_insert(item);
+        double lockFreeSeconds = run(lockFree, keys, operations, threads);
+
+        ConcurrentBST<int, PoolAllocator<int>, RedBlack> locked;
+        for (int item : shuffled)
+            locked.try_insert(item);
+        double lockedSeconds = run(locked, keys, operations, threads);
+
+        std::printf("%7u   %11.2f   %13.2f\n", threads, operations / lockFreeSeconds / 1e6,
+                    operations / lockedSeconds / 1e6);
+    }
+    return 0;
+}
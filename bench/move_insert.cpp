@@ -0,0 +1,81 @@
+/**
+ * @file move_insert.cpp
+ * @brief Benchmark: heap allocations and time per insert of long strings.
+ *
+ * Inserts the same long strings by copy (insert(const DataType&)), by
+ * move (insert(DataType&&)) and by construction inside the node
+ * (emplace), counting calls to operator new.  Node storage comes from
+ * the pool in large chunks, so the counts are essentially the string
+ * allocations.
+ *
+ * Usage: move_insert [items] [length]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "BST.h"
+
+static std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+template <typename Insert>
+void measure(const char* label, const std::vector<std::string>& items, Insert insert)
+{
+    BST<std::string, PoolAllocator<std::string>, RedBlack> tree;
+    std::vector<std::string> source = items;    // consumed by the moving variants
+    std::size_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (std::string& item : source)
+        insert(tree, item);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double count = static_cast<double>(items.size());
+    std::printf("%-26s %6.2f allocations/insert  %8.1f ns/insert\n", label,
+                static_cast<double>(allocations.load() - before) / count, 1e9 * elapsed.count() / count);
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t items = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000,
+                length = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64;
+
+    std::vector<std::string> strings;
+    strings.reserve(items);
+    for (std::size_t i = 0; i < items; ++i)
+    {
+        std::string s = std::to_string(i * 2654435761u % 1000000007u);
+        s.resize(length, 'x');
+        strings.push_back(std::move(s));
+    }
+
+    std::printf("items %zu, length %zu\n", items, length);
+    measure("insert(const std::string&)", strings,
+            [](auto& tree, std::string& s) { tree.insert(s); });
+    measure("insert(std::string&&)", strings,
+            [](auto& tree, std::string& s) { tree.insert(std::move(s)); });
+    measure("emplace(const char*, n)", strings,
+            [](auto& tree, std::string& s) { tree.emplace(s.data(), s.size()); });
+    return 0;
+}
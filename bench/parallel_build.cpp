@@ -0,0 +1,71 @@
+/**
+ * @file parallel_build.cpp
+ * @brief Benchmark: build_parallel and clear_parallel vs thread count.
+ *
+ * Builds a tree from a sorted range of strings and empties it again,
+ * first with the sequential build_sorted and clear, then with
+ * build_parallel and clear_parallel on ThreadPools of 1, 2, 4, ... 64
+ * workers.  The strings are too long for the small-string buffer, so each
+ * owns a heap block and destroying the items is real work: clear walks
+ * the tree once destroying them, while clear_parallel splits that walk
+ * among the workers before both hand the pool back at once.  (For a
+ * trivially destructible type such as int both would just release the
+ * pool, which says nothing about threads.)  The build times include
+ * validating the input, which build_parallel also splits among the
+ * workers.
+ *
+ * Usage: parallel_build [size]   (default: 2000000)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BST.h"
+
+// Returns the seconds taken by step()
+template <typename Step>
+double seconds(Step step)
+{
+    auto start = std::chrono::steady_clock::now();
+    step();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    std::vector<std::string> items(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {                                 // zero-padded, so sorted as numbers are
+        std::string digits = std::to_string(i);
+        items[i] = "parallel-build-item-" + std::string(20 - digits.size(), '0') + digits;
+    }
+
+    std::printf("%zu items, %u hardware threads\n", size, std::thread::hardware_concurrency());
+    std::printf("threads      build      clear   (M items/s)\n");
+    {
+        BST<std::string> tree;
+        double build = seconds([&] { tree.build_sorted(items.begin(), items.end()); }),
+               clear = seconds([&] { tree.clear(); });
+        std::printf("sequential %7.1f    %7.1f\n", size / build / 1e6, size / clear / 1e6);
+    }
+    for (unsigned threads = 1; threads <= 64; threads *= 2)
+    {
+        ThreadPool pool(threads);
+        BST<std::string> tree;
+        double build = seconds([&] { tree.build_parallel(items.begin(), items.end(), pool); });
+        if (tree.size() != size)
+        {
+            std::printf("FAILED: built %zu items\n", tree.size());
+            return 1;
+        }
+        double clear = seconds([&] { tree.clear_parallel(pool); });
+        std::printf("%7u    %7.1f    %7.1f\n", threads, size / build / 1e6, size / clear / 1e6);
+    }
+    return 0;
+}
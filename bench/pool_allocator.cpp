@@ -0,0 +1,60 @@
+/**
+ * @file pool_allocator.cpp
+ * @brief Benchmark: insert/remove churn with PoolAllocator vs std::allocator.
+ *
+ * Keeps a red-black tree at a fixed size while repeatedly removing a
+ * random item and inserting a new one, and reports operations per second
+ * for each node allocator.
+ *
+ * Usage: pool_allocator [items] [operations]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "BST.h"
+
+template <typename Alloc>
+double churn(std::size_t items, std::size_t operations)
+{
+    BST<int, Alloc, RedBlack> tree;
+    std::vector<int> present;
+    std::mt19937 rng(42);
+    while (present.size() < items)
+    {
+        int item = static_cast<int>(rng());
+        if (tree.try_insert(item).second)
+            present.push_back(item);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < operations; ++i)
+    {
+        std::size_t slot = rng() % present.size();
+        tree.remove(present[slot]);
+        int item;
+        do
+            item = static_cast<int>(rng());
+        while (!tree.try_insert(item).second);
+        present[slot] = item;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return 2.0 * static_cast<double>(operations) / elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t items = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000,
+                operations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000000;
+
+    double pooled = churn<PoolAllocator<int>>(items, operations),
+           plain = churn<std::allocator<int>>(items, operations);
+    std::printf("items %zu, operations %zu\n", items, 2 * operations);
+    std::printf("std::allocator  %12.0f ops/s\n", plain);
+    std::printf("PoolAllocator   %12.0f ops/s  (%.2fx)\n", pooled, pooled / plain);
+    return 0;
+}
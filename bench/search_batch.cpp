@@ -0,0 +1,62 @@
+/**
+ * @file search_batch.cpp
+ * @brief Benchmark: search_batch vs a loop of single searches.
+ *
+ * Builds a balanced tree much larger than the last-level cache and looks
+ * up random keys (about half of them hits) in batches, once through
+ * search_batch and once through one search call per key.
+ *
+ * Usage: search_batch [size] [batch]   (default: 4000000 256)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "BST.h"
+
+int main(int argc, char* argv[])
+{
+    std::size_t size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000000,
+                batch = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256,
+                lookups = 4000000 / batch * batch;
+
+    std::vector<int> items(size);
+    for (std::size_t i = 0; i < size; ++i)
+        items[i] = static_cast<int>(2 * i);
+    BST<int> tree;
+    tree.build_sorted(items.begin(), items.end());
+
+    std::mt19937 rng(11);
+    std::vector<int> keys(lookups);
+    for (int& key : keys)
+        key = static_cast<int>(rng() % (2 * size));
+    std::unique_ptr<bool[]> found(new bool[lookups]);
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < lookups; ++i)
+        found[i] = tree.search(keys[i]);
+    std::chrono::duration<double> single = std::chrono::steady_clock::now() - start;
+    std::size_t singleHits = 0;
+    for (std::size_t i = 0; i < lookups; ++i)
+        singleHits += found[i];
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < lookups; i += batch)
+        tree.search_batch(std::span<const int>(keys.data() + i, batch), std::span<bool>(found.get() + i, batch));
+    std::chrono::duration<double> batched = std::chrono::steady_clock::now() - start;
+    std::size_t batchHits = 0;
+    for (std::size_t i = 0; i < lookups; ++i)
+        batchHits += found[i];
+
+    double count = static_cast<double>(lookups);
+    std::printf("tree %zu keys, %zu lookups in batches of %zu\n", size, lookups, batch);
+    std::printf("search loop   %7.1f ns/key  (%zu hits)\n", 1e9 * single.count() / count, singleHits);
+    std::printf("search_batch  %7.1f ns/key  (%zu hits)  %.2fx\n", 1e9 * batched.count() / count, batchHits,
+                single.count() / batched.count());
+    return batchHits == singleHits ? 0 : 1;
+}
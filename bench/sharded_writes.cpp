@@ -0,0 +1,77 @@
+/**
+ * @file sharded_writes.cpp
+ * @brief Benchmark: write throughput of ShardedBST vs ConcurrentBST.
+ *
+ * Both sets start with every other key of a range, and a fixed number of
+ * random updates (try_insert or try_erase with equal odds) is split among
+ * 1, 2, 4, ... 64 threads.  ConcurrentBST serializes every update on one
+ * lock; ShardedBST, routing by hash over 16 shards, only serializes
+ * updates that land in the same shard.  Both use red-black trees.
+ *
+ * Usage: sharded_writes [size] [operations]   (default: 1000000 4000000)
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentBST.h"
+#include "ShardedBST.h"
+
+// Runs operations random updates on set split among threads threads;
+// returns the elapsed seconds
+template <typename Set>
+double run(Set& set, int keys, std::size_t operations, unsigned threads)
+{
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]
+        {
+            std::uint64_t state = 0x9E3779B97F4A7C15ull * (t + 1);
+            for (std::size_t i = t; i < operations; i += threads)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                int key = static_cast<int>(state % static_cast<std::uint64_t>(keys));
+                if ((state >> 32) % 2 == 0)
+                    set.try_insert(key);
+                else
+                    set.try_erase(key);
+            }
+        });
+    for (std::thread& worker : workers)
+        worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000,
+                operations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4000000;
+    int keys = static_cast<int>(2 * size);
+
+    std::printf("%zu items, %zu updates, %u hardware threads\n", size, operations,
+                std::thread::hardware_concurrency());
+    std::printf("threads   ShardedBST<16>   ConcurrentBST   (M updates/s)\n");
+    for (unsigned threads = 1; threads <= 64; threads *= 2)
+    {
+        ShardedBST<int, 16, PoolAllocator<int>, RedBlack> sharded;
+        ConcurrentBST<int, PoolAllocator<int>, RedBlack> locked;
+        for (int key = 0; key < keys; key += 2)
+        {
+            sharded.insert(key);
+            locked.insert(key);
+        }
+        double shardedSeconds = run(sharded, keys, operations, threads),
+               lockedSeconds = run(locked, keys, operations, threads);
+        std::printf("%7u   %14.2f   %13.2f\n", threads, operations / shardedSeconds / 1e6,
+                    operations / lockedSeconds / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file three_way_compare.cpp
+ * @brief Benchmark: key comparisons per descent, three-way vs two-way.
+ *
+ * Inserts and searches long string keys that count their comparisons.
+ * With std::less<> the descents use one operator<=> per node; with a
+ * comparator that only provides operator(), they fall back to two calls
+ * to < per node, as before the three-way descent.  The insert counts cover
+ * the whole insertion: linking the new node reuses the descent's last
+ * comparison rather than comparing against its parent again.
+ *
+ * Usage: three_way_compare [items] [length]
+ */
+
+#include <chrono>
+#include <compare>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BST.h"
+
+static std::size_t comparisons = 0;
+
+struct CountedKey
+{
+    std::string text;
+
+    friend bool operator<(const CountedKey& a, const CountedKey& b)
+    {
+        ++comparisons;
+        return a.text < b.text;
+    }
+
+    friend std::strong_ordering operator<=>(const CountedKey& a, const CountedKey& b)
+    {
+        ++comparisons;
+        return a.text <=> b.text;
+    }
+
+    friend bool operator==(const CountedKey& a, const CountedKey& b)
+    {
+        return a.text == b.text;
+    }
+};
+
+// Only operator(): BST has to call it twice per node
+struct LessOnly
+{
+    bool operator()(const CountedKey& a, const CountedKey& b) const
+    {
+        return a < b;
+    }
+};
+
+template <typename Compare>
+void measure(const char* label, const std::vector<CountedKey>& keys)
+{
+    BST<CountedKey, PoolAllocator<CountedKey>, Unbalanced, Compare> tree;
+    double count = static_cast<double>(keys.size());
+
+    comparisons = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const CountedKey& key : keys)
+        tree.try_insert(key);
+    std::chrono::duration<double> insertTime = std::chrono::steady_clock::now() - start;
+    double insertComparisons = static_cast<double>(comparisons) / count;
+
+    comparisons = 0;
+    std::size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (const CountedKey& key : keys)
+        found += tree.search(key);
+    std::chrono::duration<double> searchTime = std::chrono::steady_clock::now() - start;
+    double searchComparisons = static_cast<double>(comparisons) / count;
+
+    std::printf("%-22s insert %6.1f cmp %7.1f ns   search %6.1f cmp %7.1f ns  [%zu]\n", label,
+                insertComparisons, 1e9 * insertTime.count() / count,
+                searchComparisons, 1e9 * searchTime.count() / count, found);
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t items = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000,
+                length = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64;
+
+    // Long common prefixes make every comparison scan most of the key
+    std::mt19937 rng(3);
+    std::vector<CountedKey> keys(items);
+    for (CountedKey& key : keys)
+        key.text = std::string(length, 'k') + std::to_string(rng());
+
+    std::printf("items %zu, key length %zu+\n", items, length);
+    measure<LessOnly>("two-way (< only)", keys);
+    measure<std::less<>>("three-way (<=>)", keys);
+    return 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file traversals.cpp
+ * @brief Benchmark: nodes visited per second by the traversals.
+ *
+ * Times for_each_inorder, for_each_preorder, for_each_postorder and
+ * for_each_levelorder on a balanced tree, next to the recursive
+ * traversals they replaced.  BST no longer has those, so they run on a
+ * mirror of the same shape made of plain nodes, rebuilt from the
+ * preorder sequence (which determines the shape of a BST).  The mirror's
+ * nodes are laid out in order, like the nodes build_sorted allocates, so
+ * both walks see the same memory access pattern.
+ *
+ * Usage: traversals [size]   (default: 4000000)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "BST.h"
+
+struct MirrorNode
+{
+    int data;
+    MirrorNode* left;
+    MirrorNode* right;
+};
+
+// The items are 0 .. n-1, so item i lives in nodes[i]
+void mirrorInsert(MirrorNode*& root, std::vector<MirrorNode>& nodes, int item)
+{
+    MirrorNode** link = &root;
+    while (*link != nullptr)
+        link = item < (*link)->data ? &(*link)->left : &(*link)->right;
+    *link = &nodes[static_cast<std::size_t>(item)];
+    **link = MirrorNode{item, nullptr, nullptr};
+}
+
+void inorderRec(const MirrorNode* node, long long& sum)
+{
+    if (node != nullptr)
+    {
+        inorderRec(node->left, sum);
+        sum += node->data;
+        inorderRec(node->right, sum);
+    }
+}
+
+void preorderRec(const MirrorNode* node, long long& sum)
+{
+    if (node != nullptr)
+    {
+        sum += node->data;
+        preorderRec(node->left, sum);
+        preorderRec(node->right, sum);
+    }
+}
+
+void postorderRec(const MirrorNode* node, long long& sum)
+{
+    if (node != nullptr)
+    {
+        postorderRec(node->left, sum);
+        postorderRec(node->right, sum);
+        sum += node->data;
+    }
+}
+
+template <typename Walk>
+void measure(const char* label, std::size_t size, Walk walk)
+{
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    walk(sum);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("%-22s %8.1f M nodes/s  [%lld]\n", label,
+                static_cast<double>(size) / elapsed.count() / 1e6, sum);
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000000;
+
+    std::vector<int> items(size);
+    for (std::size_t i = 0; i < size; ++i)
+        items[i] = static_cast<int>(i);
+    BST<int> tree;
+    tree.build_sorted(items.begin(), items.end());
+
+    std::vector<MirrorNode> nodes(size);
+    MirrorNode* mirror = nullptr;
+    tree.for_each_preorder([&](int item) { mirrorInsert(mirror, nodes, item); });
+
+    std::printf("balanced tree of %zu nodes\n", size);
+    auto add = [](long long& sum) { return [&sum](int item) { sum += item; }; };
+    measure("for_each_inorder", size, [&](long long& sum) { tree.for_each_inorder(add(sum)); });
+    measure("recursive inorder", size, [&](long long& sum) { inorderRec(mirror, sum); });
+    measure("for_each_preorder", size, [&](long long& sum) { tree.for_each_preorder(add(sum)); });
+    measure("recursive preorder", size, [&](long long& sum) { preorderRec(mirror, sum); });
+    measure("for_each_postorder", size, [&](long long& sum) { tree.for_each_postorder(add(sum)); });
+    measure("recursive postorder", size, [&](long long& sum) { postorderRec(mirror, sum); });
+    measure("for_each_levelorder", size, [&](long long& sum) { tree.for_each_levelorder(add(sum)); });
+    measure("iterator walk", size, [&](long long& sum)
+            {
+                for (int item : tree)
+                    sum += item;
+            });
+    return 0;
+}
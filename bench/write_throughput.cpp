@@ -0,0 +1,69 @@
+/**
+ * @file write_throughput.cpp
+ * @brief Benchmark: write_inorder and write_graph vs inorder and graph.
+ *
+ * Dumps a balanced tree of ints into an in-memory stream once through the
+ * ostream traversals and once through their buffered counterparts, and
+ * reports the output rate in MB/s.  Both versions must produce the same
+ * text.  graph writes a line per empty subtree too, indented by depth, so
+ * it runs on a smaller tree.
+ *
+ * Usage: write_throughput [size] [graph size]   (default: 5000000 200000)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BST.h"
+
+// Times dump(out) into a fresh string stream; returns the text written
+template <typename Dump>
+std::string measure(const char* label, Dump dump, double& seconds)
+{
+    std::ostringstream out;
+    auto start = std::chrono::steady_clock::now();
+    dump(out);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    seconds = elapsed.count();
+    std::string text = std::move(out).str();
+    std::printf("%-14s %8.1f MB/s  (%zu bytes)\n", label, text.size() / seconds / 1e6, text.size());
+    return text;
+}
+
+BST<int> balancedTree(std::size_t size)
+{
+    std::vector<int> items(size);
+    for (std::size_t i = 0; i < size; ++i)
+        items[i] = static_cast<int>(i);
+    BST<int> tree;
+    tree.build_sorted(items.begin(), items.end());
+    return tree;
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000000,
+                graphSize = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    double plain, buffered;
+    bool same = true;
+
+    BST<int> tree = balancedTree(size);
+    std::printf("inorder of %zu nodes\n", size);
+    std::string expected = measure("inorder", [&](std::ostream& out) { tree.inorder(out); }, plain);
+    same &= measure("write_inorder", [&](std::ostream& out) { tree.write_inorder(out); }, buffered) == expected;
+    std::printf("%.2fx\n", plain / buffered);
+
+    tree = balancedTree(graphSize);
+    std::printf("graph of %zu nodes\n", graphSize);
+    expected = measure("graph", [&](std::ostream& out) { tree.graph(out); }, plain);
+    same &= measure("write_graph", [&](std::ostream& out) { tree.write_graph(out); }, buffered) == expected;
+    std::printf("%.2fx\n", plain / buffered);
+
+    if (!same)
+        std::printf("FAILED: buffered output differs\n");
+    return same ? 0 : 1;
+}
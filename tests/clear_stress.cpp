@@ -0,0 +1,54 @@
+/**
+ * @file clear_stress.cpp
+ * @brief Stress test: destroying and clearing 10M-node degenerate trees.
+ *
+ * Each tree is grown by joining a one-item tree onto its right, which in
+ * an unbalanced BST adds one level per item in O(1) time, so the result
+ * is as deep as it is large.  Freeing it recursively would need one stack
+ * frame per item; clear() and the destructor must not.
+ *
+ * Usage: clear_stress [items]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+#include "BST.h"
+
+BST<int> degenerateTree(int items)
+{
+    BST<int> tree;
+    for (int i = 0; i < items; ++i)
+    {
+        BST<int> single;
+        single.insert(i);
+        tree = BST<int>::join(std::move(tree), std::move(single));
+    }
+    return tree;
+}
+
+int main(int argc, char* argv[])
+{
+    int items = argc > 1 ? std::atoi(argv[1]) : 10000000;
+
+    {
+        BST<int> tree = degenerateTree(items);
+        if (tree.size() != static_cast<std::size_t>(items) || !tree.search(items / 2))
+        {
+            std::printf("FAILED: tree not built as expected\n");
+            return 1;
+        }
+    }                                   // destructor
+    std::printf("destroyed a degenerate tree of %d items\n", items);
+
+    BST<int> tree = degenerateTree(items);
+    tree.clear();
+    if (!tree.empty() || tree.size() != 0)
+    {
+        std::printf("FAILED: tree not empty after clear\n");
+        return 1;
+    }
+    std::printf("cleared a degenerate tree of %d items\n", items);
+    return 0;
+}
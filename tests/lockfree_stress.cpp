@@ -0,0 +1,258 @@
+/**
+ * @file lockfree_stress.cpp
+ * @brief Linearizability test: LockFreeBST under contended concurrent updates.
+ *
+ * Several threads mix try_insert, try_erase and search over a few keys, so
+ * most operations race with others on the same key.  Every operation is
+ * recorded with its result and with invocation and response stamps drawn
+ * from one shared counter, so an operation that responded before another
+ * was invoked has the smaller response stamp.
+ *
+ * Since the keys are independent, the history of each key is checked on
+ * its own against a sequential set holding just that key (a boolean): the
+ * operations must have an order that respects the stamps and in which
+ * every result is the one the sequential set would return.  The check
+ * sweeps the stamps, keeping every state the key could be in together with
+ * which of the pending operations have already taken effect; an operation
+ * can take effect at any point up to its response, and the history fails
+ * if, at some response, no state has that operation taking effect.  With
+ * at most one pending operation per thread this stays small.
+ *
+ * The final contents must also agree with every history, as seen by both
+ * search and for_each_inorder.  Build it with -fsanitize=thread to check
+ * for data races as well:
+ *
+ *     g++ -std=c++20 -O1 -g -fsanitize=thread -I. tests/lockfree_stress.cpp -o lockfree_stress -pthread
+ *
+ * Usage: lockfree_stress [threads] [keys] [operations per thread]
+ *        (default: 8 4 200000)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "LockFreeBST.h"
+
+enum OperationType { Insert, Erase, Search };
+
+struct Operation
+{
+    int key;
+    OperationType type;
+    bool result;
+    std::uint64_t invoked, responded;
+};
+
+struct Event
+{
+    std::uint64_t stamp;
+    int thread;
+    const Operation* operation;       // nullptr for the response
+};
+
+// Returns whether op, applied to a set that holds its key iff present,
+// gives the recorded result, and sets present to the state afterwards
+bool apply(const Operation& op, bool& present)
+{
+    switch (op.type)
+    {
+    case Insert:
+        if (op.result == present)
+            return false;
+        present = true;
+        return true;
+    case Erase:
+        if (op.result != present)
+            return false;
+        present = false;
+        return true;
+    default:
+        return op.result == present;
+    }
+}
+
+// Checks the history of one key; events must be sorted by stamp.  Sets
+// finalStates to the possible final states (bit 0 absent, bit 1 present).
+bool linearizable(const std::vector<Event>& events, int threads, unsigned& finalStates)
+{
+    // State (present, mask) is reachable iff reachable[present << threads | mask],
+    // where mask has a bit for each thread whose pending operation took effect
+    std::size_t masks = std::size_t(1) << threads;
+    std::vector<char> reachable(2 * masks, 0), next(2 * masks, 0);
+    std::vector<const Operation*> pending(threads, nullptr);
+    reachable[0] = 1;                 // the key starts absent
+
+    std::vector<std::size_t> work;
+    for (const Event& event : events)
+    {
+        if (event.operation != nullptr)
+        {                             // invocation: nothing takes effect yet
+            pending[event.thread] = event.operation;
+            continue;
+        }
+
+        // Let pending operations take effect, in any order, until nothing new
+        for (std::size_t state = 0; state < reachable.size(); ++state)
+            if (reachable[state])
+                work.push_back(state);
+        while (!work.empty())
+        {
+            std::size_t state = work.back();
+            work.pop_back();
+            for (int t = 0; t < threads; ++t)
+            {
+                std::size_t bit = std::size_t(1) << t;
+                bool present = state >= masks;
+                if (pending[t] == nullptr || (state & bit) != 0 || !apply(*pending[t], present))
+                    continue;
+                std::size_t after = (present ? masks : 0) | ((state & (masks - 1)) | bit);
+                if (!reachable[after])
+                {
+                    reachable[after] = 1;
+                    work.push_back(after);
+                }
+            }
+        }
+
+        // Keep the states in which the responding operation took effect
+        std::size_t bit = std::size_t(1) << event.thread;
+        std::fill(next.begin(), next.end(), 0);
+        bool any = false;
+        for (std::size_t state = 0; state < reachable.size(); ++state)
+            if (reachable[state] && (state & bit) != 0)
+            {
+                next[state & ~bit] = 1;
+                any = true;
+            }
+        if (!any)
+            return false;
+        reachable.swap(next);
+        pending[event.thread] = nullptr;
+    }
+
+    finalStates = (reachable[0] ? 1u : 0u) | (reachable[masks] ? 2u : 0u);
+    return true;
+}
+
+// Builds the sorted events for key from every thread's operations
+std::vector<Event> eventsOf(int key, const std::vector<std::vector<Operation>>& history)
+{
+    std::vector<Event> events;
+    for (int t = 0; t < static_cast<int>(history.size()); ++t)
+        for (const Operation& op : history[t])
+            if (op.key == key)
+            {
+                events.push_back({op.invoked, t, &op});
+                events.push_back({op.responded, t, nullptr});
+            }
+    std::sort(events.begin(), events.end(),
+              [](const Event& a, const Event& b) { return a.stamp < b.stamp; });
+    return events;
+}
+
+// Makes sure the checker rejects a history that is not linearizable: two
+// overlapping inserts of one key that both succeed
+bool checkerRejects()
+{
+    std::vector<std::vector<Operation>> history = {{{0, Insert, true, 1, 3}},
+                                                   {{0, Insert, true, 2, 4}}};
+    unsigned finalStates;
+    return !linearizable(eventsOf(0, history), 2, finalStates);
+}
+
+int main(int argc, char* argv[])
+{
+    int threads = argc > 1 ? std::atoi(argv[1]) : 8,
+        keys = argc > 2 ? std::atoi(argv[2]) : 4,
+        operations = argc > 3 ? std::atoi(argv[3]) : 200000;
+    if (threads < 1 || threads > 16)
+    {
+        std::printf("threads must be from 1 to 16\n");
+        return 1;
+    }
+    if (!checkerRejects())
+    {
+        std::printf("FAILED: checker accepted a non-linearizable history\n");
+        return 1;
+    }
+
+    LockFreeBST<int> tree;
+    std::atomic<std::uint64_t> clock(0);
+    std::vector<std::vector<Operation>> history(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t]
+        {
+            std::vector<Operation>& ops = history[t];
+            ops.reserve(operations);
+            std::uint64_t state = 0x9E3779B97F4A7C15ull * (t + 1);
+            for (int i = 0; i < operations; ++i)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                Operation op;
+                op.key = static_cast<int>(state % static_cast<std::uint64_t>(keys));
+                op.type = static_cast<OperationType>((state >> 32) % 3);
+                op.invoked = clock.fetch_add(1);
+                switch (op.type)
+                {
+                case Insert:
+                    op.result = tree.try_insert(op.key);
+                    break;
+                case Erase:
+                    op.result = tree.try_erase(op.key);
+                    break;
+                default:
+                    op.result = tree.search(op.key);
+                }
+                op.responded = clock.fetch_add(1);
+                ops.push_back(op);
+            }
+        });
+    for (std::thread& worker : workers)
+        worker.join();
+
+    std::vector<bool> visited(keys, false);
+    bool ordered = true;
+    int previous = -1;
+    tree.for_each_inorder([&](int item)
+    {
+        if (item <= previous || item >= keys)
+            ordered = false;
+        else
+            visited[item] = true;
+        previous = item;
+    });
+    if (!ordered)
+    {
+        std::printf("FAILED: for_each_inorder out of order or out of range\n");
+        return 1;
+    }
+
+    int present = 0;
+    for (int key = 0; key < keys; ++key)
+    {
+        unsigned finalStates;
+        if (!linearizable(eventsOf(key, history), threads, finalStates))
+        {
+            std::printf("FAILED: history of key %d is not linearizable\n", key);
+            return 1;
+        }
+        bool found = tree.search(key);
+        if ((finalStates & (found ? 2u : 1u)) == 0 || visited[key] != found)
+        {
+            std::printf("FAILED: final membership of key %d does not match its history\n", key);
+            return 1;
+        }
+        present += found;
+    }
+    std::printf("%d threads, %d operations each over %d keys: every key's history "
+                "linearizable, %d keys left\n", threads, operations, keys, present);
+    return 0;
+}
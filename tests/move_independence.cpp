@@ -0,0 +1,124 @@
+/**
+ * @file move_independence.cpp
+ * @brief Regression test: a moved-from tree does not share the moved-to
+ *        tree's pool.
+ *
+ * A tree is moved out of by move construction and by move assignment, and
+ * then both the moved-to and the moved-from tree are refilled and churned
+ * at the same time on two threads.  Likewise one half of a split is moved
+ * into a ConcurrentBST and churned alongside the other half.  PoolResource
+ * is not thread-safe, so this only works if the two trees no longer share
+ * one; a shared pool corrupts its free list (or is reported by
+ * -fsanitize=thread):
+ *
+ *     g++ -std=c++20 -O1 -g -fsanitize=thread -I. tests/move_independence.cpp -o move_independence -pthread
+ *
+ * Usage: move_independence [items]   (default: 200000)
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
+#include "ConcurrentBST.h"
+
+typedef BST<int, PoolAllocator<int>, RedBlack> Tree;
+
+// Inserts and removes items first .. first + items - 1 a few times over,
+// leaving the odd ones in the tree
+template <typename Set>
+void churn(Set& tree, int first, int items)
+{
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < items; ++i)
+            tree.try_insert(first + i);
+        for (int i = 0; i < items; i += 2)
+            tree.remove(first + i);
+        if (round < 2)
+            tree.clear();
+    }
+}
+
+// Checks that tree holds exactly the odd offsets from first
+template <typename Set>
+bool holdsOdd(const Set& tree, int first, int items)
+{
+    int expected = first + 1;
+    bool ok = tree.for_each_inorder([&](int item)
+    {
+        if (item != expected)
+            return false;
+        expected += 2;
+        return true;
+    });
+    return ok && tree.size() == static_cast<std::size_t>(items / 2);
+}
+
+// Churns both trees at once and checks their contents
+bool churnBoth(const char* label, Tree& a, Tree& b, int items)
+{
+    if (a.get_allocator() == b.get_allocator() && !(a.empty() && b.empty()))
+    {
+        std::printf("FAILED: %s: trees still share a pool\n", label);
+        return false;
+    }
+    std::thread other([&] { churn(b, items, items); });
+    churn(a, 0, items);
+    other.join();
+    if (!holdsOdd(a, 0, items) || !holdsOdd(b, items, items))
+    {
+        std::printf("FAILED: %s: contents wrong after concurrent churn\n", label);
+        return false;
+    }
+    if (a.get_allocator() == b.get_allocator())
+    {
+        std::printf("FAILED: %s: trees share a pool after refilling\n", label);
+        return false;
+    }
+    std::printf("%s: moved-to and moved-from trees updated independently\n", label);
+    return true;
+}
+
+// Splits a tree, moves the upper half into a ConcurrentBST and churns it
+// and the lower half at once
+bool churnSplit(int items)
+{
+    Tree whole;
+    for (int i = 0; i < 2 * items; ++i)
+        whole.insert(i);
+    std::pair<Tree, Tree> halves = whole.split(items);
+    ConcurrentBST<int, PoolAllocator<int>, RedBlack> wrapped(std::move(halves.second));
+    std::thread other([&] { churn(wrapped, items, items); });
+    churn(halves.first, 0, items);
+    other.join();
+    if (!holdsOdd(halves.first, 0, items) || !holdsOdd(wrapped, items, items))
+    {
+        std::printf("FAILED: split half in ConcurrentBST: contents wrong after concurrent churn\n");
+        return false;
+    }
+    std::printf("split half in ConcurrentBST: both halves updated independently\n");
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    int items = argc > 1 ? std::atoi(argv[1]) : 200000;
+    bool passed = true;
+
+    Tree source;
+    for (int i = 0; i < items; ++i)
+        source.insert(i);
+    Tree constructed(std::move(source));
+    passed &= churnBoth("move construction", constructed, source, items);
+
+    Tree assigned;
+    assigned.insert(-1);
+    assigned = std::move(constructed);
+    passed &= churnBoth("move assignment", assigned, constructed, items);
+
+    passed &= churnSplit(items);
+
+    return passed ? 0 : 1;
+}
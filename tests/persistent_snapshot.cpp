@@ -0,0 +1,133 @@
+/**
+ * @file persistent_snapshot.cpp
+ * @brief Regression test: PersistentBST snapshots do not change when the
+ *        tree they were taken from does.
+ *
+ * Random inserts and removes are applied to a PersistentBST and to a
+ * std::set.  Every so often a snapshot is taken along with a copy of the
+ * std::set.  After all updates (and a final clear) every snapshot must
+ * still hold exactly the items of its copy, as seen by size, search,
+ * for_each_inorder, lower_bound and range, and the live tree must match
+ * the std::set throughout.
+ *
+ * Usage: persistent_snapshot [operations] [keys]   (default: 200000 2000)
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "PersistentBST.h"
+
+typedef PersistentBST<int> Tree;
+
+// Checks that tree holds exactly the items of expected, keys 0 .. keys - 1
+bool matches(const Tree& tree, const std::set<int>& expected, int keys)
+{
+    if (tree.size() != expected.size() || tree.empty() != expected.empty())
+        return false;
+
+    auto next = expected.begin();
+    bool inOrder = tree.for_each_inorder([&](int item)
+    {
+        if (next == expected.end() || item != *next)
+            return false;
+        ++next;
+        return true;
+    });
+    if (!inOrder || next != expected.end())
+        return false;
+
+    for (int key = 0; key < keys; ++key)
+    {
+        if (tree.search(key) != (expected.count(key) == 1))
+            return false;
+        const int* found = tree.lower_bound(key);
+        auto wanted = expected.lower_bound(key);
+        if ((found == nullptr) != (wanted == expected.end()) ||
+            (found != nullptr && *found != *wanted))
+            return false;
+    }
+
+    int low = keys / 4, high = 3 * keys / 4;
+    auto wanted = expected.lower_bound(low);
+    bool inRange = tree.range(low, high, [&](int item)
+    {
+        if (wanted == expected.end() || item != *wanted)
+            return false;
+        ++wanted;
+        return true;
+    });
+    return inRange && (wanted == expected.end() || *wanted >= high);
+}
+
+int main(int argc, char* argv[])
+{
+    int operations = argc > 1 ? std::atoi(argv[1]) : 200000,
+        keys = argc > 2 ? std::atoi(argv[2]) : 2000;
+    int interval = operations / 50 > 0 ? operations / 50 : 1;
+
+    Tree tree;
+    std::set<int> model;
+    std::vector<std::pair<Tree, std::set<int>>> snapshots;
+    std::uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < operations; ++i)
+    {
+        if (i % interval == 0)
+            snapshots.emplace_back(tree.snapshot(), model);
+
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int key = static_cast<int>(state % static_cast<std::uint64_t>(keys));
+        switch ((state >> 32) % 4)
+        {
+        case 0:                       // insert and remove throw on misuse
+            if (model.insert(key).second)
+                tree.insert(key);
+            break;
+        case 1:
+            if (tree.try_insert(key) != model.insert(key).second)
+            {
+                std::printf("FAILED: try_insert(%d) disagrees with std::set\n", key);
+                return 1;
+            }
+            break;
+        case 2:
+            if (model.erase(key) == 1)
+                tree.remove(key);
+            break;
+        default:
+            if (tree.try_erase(key) != (model.erase(key) == 1))
+            {
+                std::printf("FAILED: try_erase(%d) disagrees with std::set\n", key);
+                return 1;
+            }
+        }
+    }
+    snapshots.emplace_back(tree.snapshot(), model);
+    if (!matches(tree, model, keys))
+    {
+        std::printf("FAILED: live tree does not match std::set\n");
+        return 1;
+    }
+    tree.clear();
+    if (!tree.empty() || !matches(tree, std::set<int>(), keys))
+    {
+        std::printf("FAILED: live tree not empty after clear\n");
+        return 1;
+    }
+
+    for (std::size_t s = 0; s < snapshots.size(); ++s)
+        if (!matches(snapshots[s].first, snapshots[s].second, keys))
+        {
+            std::printf("FAILED: snapshot %zu changed after later updates\n", s);
+            return 1;
+        }
+    std::printf("%d updates over %d keys: %zu snapshots unchanged\n", operations, keys,
+                snapshots.size());
+    return 0;
+}
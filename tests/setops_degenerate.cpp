@@ -0,0 +1,77 @@
+/**
+ * @file setops_degenerate.cpp
+ * @brief Regression test: set operations on degenerate unbalanced trees.
+ *
+ * The operands are grown by joining one-item trees onto their right, so
+ * each is as deep as it is large.  set_union, set_intersection and
+ * set_difference used to recurse once per level of the second operand and
+ * overflowed the stack on such trees; their results are checked against
+ * std::set_union and friends on the same items.
+ *
+ * Usage: setops_degenerate [items]   (default: 200000)
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "BST.h"
+
+// Items 0, step, 2 * step, ... in a tree with one level per item
+BST<int> degenerateTree(int items, int step)
+{
+    BST<int> tree;
+    for (int i = 0; i < items; ++i)
+    {
+        BST<int> single;
+        single.insert(i * step);
+        tree = BST<int>::join(std::move(tree), std::move(single));
+    }
+    return tree;
+}
+
+std::vector<int> itemsOf(const BST<int>& tree)
+{
+    std::vector<int> items;
+    tree.for_each_inorder([&items](int item) { items.push_back(item); });
+    return items;
+}
+
+bool check(const char* label, const BST<int>& result, const std::vector<int>& expected)
+{
+    if (result.size() != expected.size() || itemsOf(result) != expected)
+    {
+        std::printf("FAILED: %s of degenerate trees\n", label);
+        return false;
+    }
+    std::printf("%s of degenerate trees: %zu items\n", label, expected.size());
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    int items = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    std::vector<int> a = itemsOf(degenerateTree(items, 2)),
+                     b = itemsOf(degenerateTree(items, 3)),
+                     expected;
+    bool passed = true;
+
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    passed &= check("union", BST<int>::set_union(degenerateTree(items, 2), degenerateTree(items, 3)), expected);
+
+    expected.clear();
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    passed &= check("intersection",
+                    BST<int>::set_intersection(degenerateTree(items, 2), degenerateTree(items, 3)), expected);
+
+    expected.clear();
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    passed &= check("difference",
+                    BST<int>::set_difference(degenerateTree(items, 2), degenerateTree(items, 3)), expected);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file split_scaling.cpp
+ * @brief Regression test: split and join of a red-black tree with
+ *        OrderStatistics cost O(log n), not O(n).
+ *
+ * Trees of 10K, 100K and 1M items are repeatedly split near the median and
+ * joined back together.  The sizes of both halves come from the subtree
+ * counts, so a round trip should cost about the same at every size; the
+ * test fails if the time per round grows by more than a small factor from
+ * the smallest tree to the largest (a hundredfold for anything linear).
+ * Every split is also checked for the right sizes, and for leaving the
+ * source empty and no longer sharing the halves' pool.
+ *
+ * Usage: split_scaling [rounds]   (default: 20000)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "BST.h"
+
+typedef BST<int, PoolAllocator<int>, RedBlack, std::less<>, true> Tree;
+
+// Returns the best time per split-and-join round on a tree of size items,
+// or a negative value if a split gave the wrong result
+double timeRound(int size, int rounds)
+{
+    std::vector<int> items(size);
+    for (int i = 0; i < size; ++i)
+        items[i] = i;
+    Tree tree;
+    tree.build_sorted(items.begin(), items.end());
+
+    double best = 1e9;
+    for (int repeat = 0; repeat < 5; ++repeat)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i)
+        {
+            int key = size / 2 + i % 64 - 32;
+            std::pair<Tree, Tree> halves = tree.split(key);
+            if (halves.first.size() != static_cast<std::size_t>(key) ||
+                halves.second.size() != static_cast<std::size_t>(size - key))
+                return -1;
+            if (!tree.empty() || tree.get_allocator() == halves.first.get_allocator())
+                return -1;                // the emptied tree must not keep the pool
+            tree = Tree::join(std::move(halves.first), std::move(halves.second));
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / rounds);
+    }
+    return tree.size() == static_cast<std::size_t>(size) ? best : -1;
+}
+
+int main(int argc, char* argv[])
+{
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 20000;
+
+    double smallest = 0, largest = 0;
+    for (int size = 10000; size <= 1000000; size *= 10)
+    {
+        double perRound = timeRound(size, rounds);
+        if (perRound < 0)
+        {
+            std::printf("FAILED: split of %d items gave wrong sizes or kept the pool\n", size);
+            return 1;
+        }
+        std::printf("%8d items: %7.1f ns per split and join\n", size, 1e9 * perRound);
+        if (smallest == 0)
+            smallest = perRound;
+        largest = perRound;
+    }
+    if (largest > 8 * smallest)
+    {
+        std::printf("FAILED: 100 times the items made split and join %.1f times slower\n",
+                    largest / smallest);
+        return 1;
+    }
+    return 0;
+}